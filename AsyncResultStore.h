@@ -0,0 +1,238 @@
+//
+// 分片、带过期时间的异步结果表，键为 (客户端标识, 请求 id)
+//
+
+#ifndef JSON_RPC_ASYNC_RESULT_STORE_H
+#define JSON_RPC_ASYNC_RESULT_STORE_H
+
+#include <jsoncpp/json/json.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+class AsyncResultStore {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Status {
+        NotFound,
+        Pending,
+        Ready
+    };
+
+    struct Stats {
+        size_t size;
+        uint64_t expired;   // 超过 TTL 未被取走而清除的结果数
+        uint64_t evicted;   // 超过容量上限而淘汰的结果数
+    };
+
+    // maxSize 为所有分片合计的上限，超过时淘汰全表最早写入的结果；并发写入时可能短暂超出，超出量不多于同时写入的线程数
+    explicit AsyncResultStore(std::chrono::milliseconds ttl = std::chrono::minutes(5), size_t maxSize = 65536);
+
+    // 同一键重复提交时覆盖旧结果
+    void put(const std::string &client, int id, std::future<Json::Value> future);
+
+    // 结果就绪时移出到 out 并返回 Ready，调用方负责 get()
+    Status take(const std::string &client, int id, std::future<Json::Value> &out);
+
+    // 删除 (client, id) 的结果，不论是否就绪；客户端已通过其他途径拿到结果时调用
+    void discard(const std::string &client, int id);
+
+    // 顺带清除所有分片中已过期的结果
+    Stats stats();
+
+private:
+    static constexpr size_t SHARD_COUNT = 16;
+
+    struct Key {
+        std::string client;
+        int id;
+
+        bool operator==(const Key &other) const { return id == other.id && client == other.client; }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key &key) const {
+            return std::hash<std::string>{}(key.client) * 31 + std::hash<int>{}(key.id);
+        }
+    };
+
+    struct Entry {
+        std::future<Json::Value> future;
+        Clock::time_point expireAt;
+    };
+
+    // TTL 固定，插入顺序即过期顺序；order 中已被取走或覆盖的记录在清理时跳过
+    struct alignas(64) Shard {
+        std::mutex mtx;
+        std::unordered_map<Key, Entry, KeyHash> entries;
+        std::deque<std::pair<Key, Clock::time_point>> order;
+    };
+
+    Shard &shardFor(const Key &key) { return m_shards[KeyHash{}(key) % SHARD_COUNT]; }
+
+    // 清除过期结果；调用方持有 shard.mtx
+    void purge(Shard &shard, Clock::time_point now);
+
+    // 去掉 order 头部已失效的记录，使其指向最早的有效结果
+    static void dropStale(Shard &shard);
+
+    // 每次存取顺带清理一个轮到的分片，没有流量落入的分片也会在 SHARD_COUNT 次操作内被清理
+    void sweepNext(Clock::time_point now);
+
+    // 淘汰全表最早写入的一条结果
+    void evictOldest();
+
+private:
+    std::array<Shard, SHARD_COUNT> m_shards;
+    const std::chrono::milliseconds m_ttl;
+    const size_t m_maxSize;
+    std::atomic<size_t> m_size{0};
+    std::atomic<size_t> m_sweep{0};
+    std::atomic<uint64_t> m_expired{0};
+    std::atomic<uint64_t> m_evicted{0};
+};
+
+inline AsyncResultStore::AsyncResultStore(std::chrono::milliseconds ttl, size_t maxSize)
+        : m_ttl(ttl), m_maxSize(maxSize > 0 ? maxSize : 1) {
+}
+
+inline void AsyncResultStore::put(const std::string &client, int id, std::future<Json::Value> future) {
+    Key key{client, id};
+    auto &shard = shardFor(key);
+    auto now = Clock::now();
+    auto expireAt = now + m_ttl;
+    size_t size = 0;
+    {
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        purge(shard, now);
+        // 在锁内计数，取走它的 take 不会先于这里减一
+        if (shard.entries.insert_or_assign(key, Entry{std::move(future), expireAt}).second) {
+            size = m_size.fetch_add(1, std::memory_order_relaxed) + 1;
+        }
+        shard.order.emplace_back(std::move(key), expireAt);
+    }
+    sweepNext(now);
+    // 只是覆盖已有的键时条目数不变，不淘汰
+    if (size > m_maxSize) {
+        evictOldest();
+    }
+}
+
+inline AsyncResultStore::Status
+AsyncResultStore::take(const std::string &client, int id, std::future<Json::Value> &out) {
+    Key key{client, id};
+    auto &shard = shardFor(key);
+    auto now = Clock::now();
+    Status status = Status::Ready;
+    {
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        purge(shard, now);
+        auto it = shard.entries.find(key);
+        if (it == shard.entries.end()) {
+            status = Status::NotFound;
+        } else if (it->second.future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            status = Status::Pending;
+        } else {
+            out = std::move(it->second.future);
+            shard.entries.erase(it);
+            m_size.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+    sweepNext(now);
+    return status;
+}
+
+inline void AsyncResultStore::discard(const std::string &client, int id) {
+    Key key{client, id};
+    auto &shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    // order 中的记录留到过期或压缩时再清理
+    if (shard.entries.erase(key) > 0) {
+        m_size.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+inline void AsyncResultStore::purge(Shard &shard, Clock::time_point now) {
+    while (!shard.order.empty() && shard.order.front().second <= now) {
+        auto it = shard.entries.find(shard.order.front().first);
+        if (it != shard.entries.end() && it->second.expireAt == shard.order.front().second) {
+            shard.entries.erase(it);
+            m_size.fetch_sub(1, std::memory_order_relaxed);
+            m_expired.fetch_add(1, std::memory_order_relaxed);
+        }
+        shard.order.pop_front();
+    }
+    // 大量结果被及时取走时 order 中多是失效记录，超过有效条目数的两倍后整体重建
+    if (shard.order.size() > 2 * shard.entries.size() + 16) {
+        std::deque<std::pair<Key, Clock::time_point>> live;
+        for (auto &record: shard.order) {
+            auto it = shard.entries.find(record.first);
+            if (it != shard.entries.end() && it->second.expireAt == record.second) {
+                live.push_back(std::move(record));
+            }
+        }
+        shard.order.swap(live);
+    }
+}
+
+inline void AsyncResultStore::dropStale(Shard &shard) {
+    while (!shard.order.empty()) {
+        auto it = shard.entries.find(shard.order.front().first);
+        if (it != shard.entries.end() && it->second.expireAt == shard.order.front().second) return;
+        shard.order.pop_front();
+    }
+}
+
+inline void AsyncResultStore::sweepNext(Clock::time_point now) {
+    auto &shard = m_shards[m_sweep.fetch_add(1, std::memory_order_relaxed) % SHARD_COUNT];
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    purge(shard, now);
+}
+
+inline void AsyncResultStore::evictOldest() {
+    while (m_size.load(std::memory_order_relaxed) > m_maxSize) {
+        // 逐个分片比较最早的有效记录，任何时刻只持有一把分片锁
+        Shard *victim = nullptr;
+        auto oldest = Clock::time_point::max();
+        for (auto &shard: m_shards) {
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            dropStale(shard);
+            if (!shard.order.empty() && shard.order.front().second < oldest) {
+                oldest = shard.order.front().second;
+                victim = &shard;
+            }
+        }
+        if (victim == nullptr) return;
+        std::lock_guard<std::mutex> lock(victim->mtx);
+        // 比较之后其他线程可能已经取走或淘汰了结果，选中的分片空了就重新比较
+        if (m_size.load(std::memory_order_relaxed) <= m_maxSize) return;
+        dropStale(*victim);
+        if (victim->order.empty()) continue;
+        victim->entries.erase(victim->order.front().first);
+        victim->order.pop_front();
+        m_size.fetch_sub(1, std::memory_order_relaxed);
+        m_evicted.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+}
+
+inline AsyncResultStore::Stats AsyncResultStore::stats() {
+    auto now = Clock::now();
+    for (auto &shard: m_shards) {
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        purge(shard, now);
+    }
+    return {m_size.load(std::memory_order_relaxed),
+            m_expired.load(std::memory_order_relaxed),
+            m_evicted.load(std::memory_order_relaxed)};
+}
+
+#endif // JSON_RPC_ASYNC_RESULT_STORE_H
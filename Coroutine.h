@@ -0,0 +1,411 @@
+//
+// 协程方法所需的 Task 类型与单线程事件循环：等待 I/O 或下游调用的协程挂起时不占用线程
+//
+
+#ifndef JSON_RPC_COROUTINE_H
+#define JSON_RPC_COROUTINE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// 惰性启动的协程返回类型，被 co_await 时才开始执行，结束后恢复等待者
+template<typename T = void>
+class Task;
+
+template<typename T>
+struct IsTask : std::false_type {
+};
+
+template<typename T>
+struct IsTask<Task<T>> : std::true_type {
+    using value_type = T;
+};
+
+namespace detail {
+
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr exception;
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    // 对称转移回等待者，避免深层调用链递归恢复导致栈溢出
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            std::coroutine_handle<> continuation = handle.promise().continuation;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() { exception = std::current_exception(); }
+};
+
+template<typename T>
+struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object();
+
+    template<typename U>
+    void return_value(U &&result) { value.emplace(std::forward<U>(result)); }
+
+    T result() {
+        if (exception) std::rethrow_exception(exception);
+        return std::move(*value);
+    }
+};
+
+template<>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object();
+
+    void return_void() {}
+
+    void result() {
+        if (exception) std::rethrow_exception(exception);
+    }
+};
+
+} // namespace detail
+
+template<typename T>
+class Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+
+    Task(Task &&other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+
+    Task &operator=(Task &&other) noexcept {
+        if (this != &other) {
+            if (m_handle) m_handle.destroy();
+            m_handle = std::exchange(other.m_handle, nullptr);
+        }
+        return *this;
+    }
+
+    Task(const Task &) = delete;
+
+    Task &operator=(const Task &) = delete;
+
+    ~Task() {
+        if (m_handle) m_handle.destroy();
+    }
+
+    auto operator co_await() noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() noexcept { return !handle || handle.done(); }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+
+            T await_resume() { return handle.promise().result(); }
+        };
+        return Awaiter{m_handle};
+    }
+
+private:
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+template<typename T>
+Task<T> detail::TaskPromise<T>::get_return_object() {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> detail::TaskPromise<void>::get_return_object() {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+// 单线程事件循环：就绪回调按提交顺序执行，定时器到期后恢复对应协程。
+// 在其上运行的协程只会在循环线程上被恢复，彼此之间无需加锁
+class EventLoop {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    EventLoop() : m_thread(&EventLoop::loop, this) {}
+
+    // 停止循环；仍挂起的协程连同其完成回调一并销毁，不再恢复
+    ~EventLoop();
+
+    EventLoop(const EventLoop &) = delete;
+
+    EventLoop &operator=(const EventLoop &) = delete;
+
+    // 线程安全，可在任意线程调用
+    void post(std::function<void()> callback) {
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_ready.push_back(std::move(callback));
+        }
+        m_cond.notify_one();
+    }
+
+    // co_await loop.schedule() 后协程在循环线程上继续执行
+    auto schedule() {
+        struct Awaiter {
+            EventLoop *loop;
+
+            bool await_ready() const noexcept { return false; }
+
+            void await_suspend(std::coroutine_handle<> handle) { loop->post([handle] { handle.resume(); }); }
+
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{this};
+    }
+
+    // 挂起当前协程 duration 后在循环线程上恢复，期间不占用线程
+    auto sleepFor(Clock::duration duration) {
+        struct Awaiter {
+            EventLoop *loop;
+            Clock::time_point deadline;
+
+            bool await_ready() const noexcept { return false; }
+
+            void await_suspend(std::coroutine_handle<> handle) { loop->addTimer(deadline, handle); }
+
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{this, Clock::now() + duration};
+    }
+
+    // 把基于回调的异步接口接入协程：start 收到一个 resume(T) 回调，在任意线程调用它即可让协程带着结果继续，例如
+    // Json::Value r = co_await loop.callback<Json::Value>([&](auto resume) { client.callAsync(..., resume); });
+    // 循环析构后才到达的 resume 会被丢弃，此时协程帧已随顶层协程销毁
+    template<typename T, typename Start>
+    auto callback(Start start) {
+        struct Awaiter {
+            std::shared_ptr<Lifetime> lifetime;
+            Start start;
+            // 结果放在共享状态里，resume 不引用可能已销毁的协程帧
+            std::shared_ptr<std::optional<T>> value = std::make_shared<std::optional<T>>();
+
+            bool await_ready() const noexcept { return false; }
+
+            void await_suspend(std::coroutine_handle<> handle) {
+                start([lifetime = lifetime, value = value, handle](T result) {
+                    std::lock_guard<std::mutex> lock(lifetime->mtx);
+                    if (!lifetime->loop) return;
+                    value->emplace(std::move(result));
+                    lifetime->loop->post([handle] { handle.resume(); });
+                });
+            }
+
+            T await_resume() { return std::move(**value); }
+        };
+        return Awaiter{m_lifetime, std::move(start)};
+    }
+
+    // 在循环线程上启动 task，结束后在循环线程上调用 done(exception)（Task<void>）或 done(exception, std::optional<T>)
+    template<typename T, typename Done>
+    void spawn(Task<T> task, Done done);
+
+    // 当前线程所在的事件循环，不在循环线程上时为空
+    static EventLoop *current() { return t_current; }
+
+private:
+    // 由 spawn 启动的顶层协程，结束后自行销毁
+    struct Detached {
+        struct promise_type {
+            EventLoop *loop = nullptr;
+
+            Detached get_return_object() {
+                return Detached{std::coroutine_handle<promise_type>::from_promise(*this)};
+            }
+
+            std::suspend_always initial_suspend() noexcept { return {}; }
+
+            std::suspend_never final_suspend() noexcept { return {}; }
+
+            void return_void() {}
+
+            void unhandled_exception() { std::terminate(); }
+
+            ~promise_type() {
+                if (loop) loop->forget(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+        };
+
+        std::coroutine_handle<promise_type> handle;
+    };
+
+    // 由 callback 交出的 resume 共享；析构时在锁内置空 loop，之后到达的完成不再投递
+    struct Lifetime {
+        explicit Lifetime(EventLoop *loop) : loop(loop) {}
+
+        std::mutex mtx;
+        EventLoop *loop;
+    };
+
+    struct Timer {
+        Clock::time_point deadline;
+        uint64_t sequence;      // 到期时间相同时按加入顺序恢复
+        std::coroutine_handle<> handle;
+
+        bool operator>(const Timer &other) const {
+            return deadline != other.deadline ? deadline > other.deadline : sequence > other.sequence;
+        }
+    };
+
+    // 完成回调统一擦除为 std::function，顶层协程帧只随 T 实例化
+    template<typename T>
+    struct Completion {
+        using type = std::function<void(std::exception_ptr, std::optional<T>)>;
+    };
+
+    template<typename T>
+    static Detached run(Task<T> task, typename Completion<T>::type done);
+
+    void addTimer(Clock::time_point deadline, std::coroutine_handle<> handle) {
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_timers.push({deadline, m_timerSequence++, handle});
+        }
+        m_cond.notify_one();
+    }
+
+    void forget(std::coroutine_handle<> root) {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_roots.erase(root.address());
+    }
+
+    void loop();
+
+private:
+    std::mutex m_mtx;
+    std::condition_variable m_cond;
+    std::deque<std::function<void()>> m_ready;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<>> m_timers;
+    uint64_t m_timerSequence = 0;
+    std::unordered_set<void *> m_roots;     // 尚未结束的顶层协程
+    bool m_stop = false;
+    std::shared_ptr<Lifetime> m_lifetime = std::make_shared<Lifetime>(this);
+    std::thread m_thread;
+
+    static thread_local EventLoop *t_current;
+};
+
+inline thread_local EventLoop *EventLoop::t_current = nullptr;
+
+template<>
+struct EventLoop::Completion<void> {
+    using type = std::function<void(std::exception_ptr)>;
+};
+
+template<typename T>
+EventLoop::Detached EventLoop::run(Task<T> task, typename Completion<T>::type done) {
+    std::exception_ptr error;
+    if constexpr (std::is_void_v<T>) {
+        try {
+            co_await task;
+        } catch (...) {
+            error = std::current_exception();
+        }
+        done(error);
+    } else {
+        std::optional<T> value;
+        try {
+            value.emplace(co_await task);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        done(error, std::move(value));
+    }
+}
+
+template<typename T, typename Done>
+void EventLoop::spawn(Task<T> task, Done done) {
+    Detached root = run<T>(std::move(task), std::move(done));
+    root.handle.promise().loop = this;
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_roots.insert(root.handle.address());
+    }
+    post([handle = root.handle] { handle.resume(); });
+}
+
+inline EventLoop::~EventLoop() {
+    {
+        // 此后其他线程调用的 resume 不再触碰本循环与协程帧
+        std::lock_guard<std::mutex> lock(m_lifetime->mtx);
+        m_lifetime->loop = nullptr;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_stop = true;
+    }
+    m_cond.notify_one();
+    m_thread.join();
+    // 定时器与就绪队列引用的都是顶层协程内部的帧，随顶层协程一起销毁
+    m_ready.clear();
+    m_timers = {};
+    std::vector<void *> roots(m_roots.begin(), m_roots.end());
+    m_roots.clear();
+    for (void *root: roots) {
+        auto handle = std::coroutine_handle<Detached::promise_type>::from_address(root);
+        handle.promise().loop = nullptr;
+        handle.destroy();
+    }
+}
+
+inline void EventLoop::loop() {
+    t_current = this;
+    std::deque<std::function<void()>> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mtx);
+            while (!m_stop && m_ready.empty()) {
+                if (m_timers.empty()) {
+                    m_cond.wait(lock);
+                } else if (m_timers.top().deadline <= Clock::now()) {
+                    break;
+                } else {
+                    m_cond.wait_until(lock, m_timers.top().deadline);
+                }
+            }
+            if (m_stop) break;
+            Clock::time_point now = Clock::now();
+            while (!m_timers.empty() && m_timers.top().deadline <= now) {
+                std::coroutine_handle<> handle = m_timers.top().handle;
+                m_timers.pop();
+                m_ready.push_back([handle] { handle.resume(); });
+            }
+            batch.swap(m_ready);
+        }
+        // 锁外执行，回调中可以继续 post 或加定时器
+        for (auto &callback: batch) {
+            callback();
+        }
+        batch.clear();
+    }
+    t_current = nullptr;
+}
+
+#endif // JSON_RPC_COROUTINE_H
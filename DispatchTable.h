@@ -0,0 +1,81 @@
+//
+// 只读的开放寻址方法表，构建后不再修改，键的哈希在构建时预先计算
+//
+
+#ifndef JSON_RPC_DISPATCH_TABLE_H
+#define JSON_RPC_DISPATCH_TABLE_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+template<typename V>
+class DispatchTable {
+public:
+    DispatchTable() : m_slots(1, 0), m_mask(0) {}
+
+    // 由完整的条目集合构建，键不可重复
+    explicit DispatchTable(std::vector<std::pair<std::string, V>> entries) {
+        m_entries.reserve(entries.size());
+        for (auto &[key, value]: entries) {
+            size_t hash = hashOf(key);
+            m_entries.push_back({hash, std::move(key), std::move(value)});
+        }
+        // 装载因子不超过 1/2，线性探测平均一两次即可命中
+        size_t capacity = 1;
+        while (capacity < m_entries.size() * 2) capacity <<= 1;
+        m_slots.assign(capacity, 0);
+        m_mask = capacity - 1;
+        for (uint32_t i = 0; i < m_entries.size(); ++i) {
+            size_t slot = m_entries[i].hash & m_mask;
+            while (m_slots[slot] != 0) slot = (slot + 1) & m_mask;
+            m_slots[slot] = i + 1;
+        }
+    }
+
+    const V *find(std::string_view key) const {
+        size_t hash = hashOf(key);
+        for (size_t slot = hash & m_mask; m_slots[slot] != 0; slot = (slot + 1) & m_mask) {
+            const Entry &entry = m_entries[m_slots[slot] - 1];
+            if (entry.hash == hash && entry.key == key) return &entry.value;
+        }
+        return nullptr;
+    }
+
+    // 复制全部条目并插入或覆盖 key，返回新表，原表保持不变
+    DispatchTable with(const std::string &key, V value) const {
+        std::vector<std::pair<std::string, V>> entries;
+        entries.reserve(m_entries.size() + 1);
+        for (const auto &entry: m_entries) {
+            if (entry.key != key) entries.emplace_back(entry.key, entry.value);
+        }
+        entries.emplace_back(key, std::move(value));
+        return DispatchTable(std::move(entries));
+    }
+
+    size_t size() const { return m_entries.size(); }
+
+    // 按插入顺序以 (key, value) 调用 func
+    template<typename F>
+    void forEach(F func) const {
+        for (const auto &entry: m_entries) func(entry.key, entry.value);
+    }
+
+private:
+    struct Entry {
+        size_t hash;
+        std::string key;
+        V value;
+    };
+
+    static size_t hashOf(std::string_view key) { return std::hash<std::string_view>{}(key); }
+
+    std::vector<Entry> m_entries;
+    std::vector<uint32_t> m_slots;   // 0 表示空槽，否则为条目下标加一
+    size_t m_mask;
+};
+
+#endif // JSON_RPC_DISPATCH_TABLE_H
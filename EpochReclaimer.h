@@ -0,0 +1,128 @@
+//
+// 基于纪元的延迟回收：读者进入临界区时在本线程的槽位登记当前纪元，写者替换对象后带着新纪元挂起旧对象，
+// 等所有更早进入的读者离开后再释放。读者只写自己的缓存行，不与其他线程竞争
+//
+
+#ifndef JSON_RPC_EPOCH_RECLAIMER_H
+#define JSON_RPC_EPOCH_RECLAIMER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class EpochReclaimer {
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch{0};     // 0 表示不在临界区
+        std::atomic<bool> used{false};
+        uint32_t depth = 0;                 // 只由占用该槽位的线程访问
+    };
+
+public:
+    // 读临界区，可嵌套。其中读取受保护的原子指针须用 seq_cst，读到的对象在 Guard 析构前不会被释放
+    class Guard {
+    public:
+        Guard() : m_slot(localSlot()) {
+            if (m_slot.depth++ == 0) {
+                m_slot.epoch.store(s_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+            }
+        }
+
+        ~Guard() {
+            if (--m_slot.depth == 0) m_slot.epoch.store(0, std::memory_order_release);
+        }
+
+        Guard(const Guard &) = delete;
+
+        Guard &operator=(const Guard &) = delete;
+
+    private:
+        Slot &m_slot;
+    };
+
+    EpochReclaimer() = default;
+
+    EpochReclaimer(const EpochReclaimer &) = delete;
+
+    EpochReclaimer &operator=(const EpochReclaimer &) = delete;
+
+    // 旧对象已用 seq_cst 从原子指针上替换下来之后调用，写者之间由调用方互斥；顺带释放已无读者的对象
+    template<typename T>
+    void retire(std::unique_ptr<T> object) {
+        if (!object) return;
+        uint64_t epoch = s_epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+        m_retired.push_back({epoch, std::shared_ptr<const void>(std::move(object))});
+        collect();
+    }
+
+    // 仍在等待读者离开的对象个数
+    size_t pending() const { return m_retired.size(); }
+
+    void collect() {
+        uint64_t oldest = std::numeric_limits<uint64_t>::max();
+        Registry &registry = Registry::instance();
+        {
+            std::lock_guard<std::mutex> lock(registry.mtx);
+            for (const auto &slot: registry.slots) {
+                uint64_t epoch = slot->epoch.load(std::memory_order_seq_cst);
+                if (epoch != 0 && epoch < oldest) oldest = epoch;
+            }
+        }
+        // 登记纪元不早于退休纪元的读者是在替换之后进入的，只可能读到新对象
+        std::erase_if(m_retired, [oldest](const Retired &retired) { return retired.epoch <= oldest; });
+    }
+
+private:
+    struct Retired {
+        uint64_t epoch;
+        std::shared_ptr<const void> object;
+    };
+
+    // 槽位只增不减，线程退出后由后来的线程复用；有意不析构，避免与其他线程的 thread_local 析构顺序冲突
+    struct Registry {
+        std::mutex mtx;
+        std::vector<std::unique_ptr<Slot>> slots;
+
+        static Registry &instance() {
+            static auto *registry = new Registry;
+            return *registry;
+        }
+    };
+
+    struct Lease {
+        Slot *slot;
+
+        Lease() {
+            Registry &registry = Registry::instance();
+            std::lock_guard<std::mutex> lock(registry.mtx);
+            auto it = std::find_if(registry.slots.begin(), registry.slots.end(),
+                                   [](const auto &slot) { return !slot->used.load(std::memory_order_relaxed); });
+            if (it == registry.slots.end()) {
+                registry.slots.push_back(std::make_unique<Slot>());
+                it = registry.slots.end() - 1;
+            }
+            slot = it->get();
+            slot->used.store(true, std::memory_order_relaxed);
+        }
+
+        ~Lease() {
+            Registry &registry = Registry::instance();
+            std::lock_guard<std::mutex> lock(registry.mtx);
+            slot->used.store(false, std::memory_order_relaxed);
+        }
+    };
+
+    static Slot &localSlot() {
+        thread_local Lease lease;
+        return *lease.slot;
+    }
+
+    inline static std::atomic<uint64_t> s_epoch{1};
+
+    std::vector<Retired> m_retired;
+};
+
+#endif // JSON_RPC_EPOCH_RECLAIMER_H
@@ -0,0 +1,308 @@
+//
+// JSON 编解码层：解析与缩进输出使用 jsoncpp，紧凑输出使用 JsonFastWriter。
+// 定义 JSONRPC_USE_SIMDJSON（CMake 选项 JSONRPC_USE_SIMDJSON）时改用 simdjson on-demand 解析
+//
+
+#ifndef JSON_RPC_CODEC_H
+#define JSON_RPC_CODEC_H
+
+#include <jsoncpp/json/json.h>
+#include <charconv>
+#include <cmath>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#ifdef JSONRPC_USE_SIMDJSON
+#include <simdjson.h>
+#endif
+
+enum class JsonOutputStyle {
+    Compact,    // 无缩进、无换行，用于线上传输
+    Styled      // 与 toStyledString 相同的缩进格式，便于调试
+};
+
+// 直接向 std::string 追加的紧凑格式输出，不经过 ostream。与 jsoncpp 紧凑格式（emitUTF8）逐字节相同：
+// 浮点数按 17 位有效数字输出，非有限值按 jsoncpp 的写法
+class JsonFastWriter {
+public:
+    static void write(const Json::Value &value, std::string &out) {
+        switch (value.type()) {
+            case Json::nullValue:
+                out.append("null", 4);
+                break;
+            case Json::booleanValue:
+                value.asBool() ? out.append("true", 4) : out.append("false", 5);
+                break;
+            case Json::intValue:
+                appendNumber(out, value.asLargestInt());
+                break;
+            case Json::uintValue:
+                appendNumber(out, value.asLargestUInt());
+                break;
+            case Json::realValue:
+                appendReal(out, value.asDouble());
+                break;
+            case Json::stringValue: {
+                const char *begin = nullptr;
+                const char *end = nullptr;
+                value.getString(&begin, &end);
+                appendString(out, begin, end);
+                break;
+            }
+            case Json::arrayValue: {
+                out.push_back('[');
+                Json::ArrayIndex size = value.size();
+                for (Json::ArrayIndex i = 0; i < size; ++i) {
+                    if (i > 0) out.push_back(',');
+                    write(value[i], out);
+                }
+                out.push_back(']');
+                break;
+            }
+            case Json::objectValue: {
+                out.push_back('{');
+                bool first = true;
+                for (auto it = value.begin(); it != value.end(); ++it) {
+                    if (!first) out.push_back(',');
+                    first = false;
+                    const char *end = nullptr;
+                    const char *begin = it.memberName(&end);
+                    appendString(out, begin, end);
+                    out.push_back(':');
+                    write(*it, out);
+                }
+                out.push_back('}');
+                break;
+            }
+        }
+    }
+
+private:
+    template<typename T>
+    static void appendNumber(std::string &out, T number) {
+        char buf[24];
+        auto [end, ec] = std::to_chars(buf, buf + sizeof buf, number);
+        out.append(buf, end);
+    }
+
+    static void appendReal(std::string &out, double number) {
+        if (std::isnan(number)) {
+            out.append("null", 4);
+            return;
+        }
+        if (std::isinf(number)) {
+            number < 0 ? out.append("-1e+9999", 8) : out.append("1e+9999", 7);
+            return;
+        }
+        // 与 printf("%.17g") 相同，但不受 locale 影响
+        char buf[32];
+        auto [end, ec] = std::to_chars(buf, buf + sizeof buf, number, std::chars_format::general, 17);
+        out.append(buf, end);
+        // 保证读回后仍为浮点数
+        if (std::string_view(buf, end - buf).find_first_of(".e") == std::string_view::npos) {
+            out.append(".0", 2);
+        }
+    }
+
+    static void appendString(std::string &out, const char *begin, const char *end) {
+        static const char hex[] = "0123456789abcdef";
+        out.push_back('"');
+        const char *run = begin;
+        for (const char *p = begin; p != end; ++p) {
+            auto c = static_cast<unsigned char>(*p);
+            if (c >= 0x20 && c != '"' && c != '\\') continue;
+            out.append(run, p);
+            run = p + 1;
+            switch (c) {
+                case '"': out.append("\\\"", 2); break;
+                case '\\': out.append("\\\\", 2); break;
+                case '\n': out.append("\\n", 2); break;
+                case '\r': out.append("\\r", 2); break;
+                case '\t': out.append("\\t", 2); break;
+                case '\b': out.append("\\b", 2); break;
+                case '\f': out.append("\\f", 2); break;
+                default: {
+                    char esc[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf]};
+                    out.append(esc, 6);
+                }
+            }
+        }
+        out.append(run, end);
+        out.push_back('"');
+    }
+};
+
+// 直接写入目标 std::string 的流缓冲区，避免 ostringstream::str() 再拷贝一次
+class StringSink : public std::streambuf {
+public:
+    void reset(std::string *target) { m_target = target; }
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            m_target->push_back(traits_type::to_char_type(ch));
+        }
+        return ch;
+    }
+
+    std::streamsize xsputn(const char *str, std::streamsize count) override {
+        m_target->append(str, static_cast<size_t>(count));
+        return count;
+    }
+
+private:
+    std::string *m_target = nullptr;
+};
+
+// jsoncpp 的 CharReader 与缩进格式的 StreamWriter 每个线程各缓存一份，紧凑输出走 JsonFastWriter
+struct JsoncppCodec {
+    static bool parse(const char *begin, const char *end, Json::Value &out, std::string *errs) {
+        thread_local std::unique_ptr<Json::CharReader> reader = makeReader();
+        return reader->parse(begin, end, &out, errs);
+    }
+
+    static std::string serialize(const Json::Value &value, JsonOutputStyle style) {
+        std::string out;
+        if (style == JsonOutputStyle::Compact) {
+            JsonFastWriter::write(value, out);
+            return out;
+        }
+        thread_local std::unique_ptr<Json::StreamWriter> styledWriter = makeStyledWriter();
+        thread_local StringSink sink;
+        thread_local std::ostream os(&sink);
+        sink.reset(&out);
+        os.clear();
+        styledWriter->write(value, &os);
+        sink.reset(nullptr);
+        return out;
+    }
+
+private:
+    static std::unique_ptr<Json::CharReader> makeReader() {
+        Json::CharReaderBuilder builder;
+        builder["collectComments"] = false;
+        return std::unique_ptr<Json::CharReader>(builder.newCharReader());
+    }
+
+    static std::unique_ptr<Json::StreamWriter> makeStyledWriter() {
+        Json::StreamWriterBuilder builder;
+        builder["commentStyle"] = "None";
+        builder["emitUTF8"] = true;
+        builder["indentation"] = "\t";
+        return std::unique_ptr<Json::StreamWriter>(builder.newStreamWriter());
+    }
+};
+
+#ifdef JSONRPC_USE_SIMDJSON
+// simdjson on-demand 解析后转换为 Json::Value，供批量、异步、协程等需要完整请求的路径使用，结果与 jsoncpp 相同。
+// 单个同步请求由 JsonRpcServer 直接从解析器视图解码参数，不经过这里；输出仍走 JsoncppCodec
+struct SimdjsonCodec {
+    static bool parse(const char *begin, const char *end, Json::Value &out, std::string *errs) {
+        thread_local simdjson::ondemand::parser parser;
+        thread_local std::string input;
+        auto size = static_cast<size_t>(end - begin);
+        input.reserve(size + simdjson::SIMDJSON_PADDING);
+        input.assign(begin, size);
+        simdjson::ondemand::document document;
+        simdjson::error_code error = parser.iterate(input.data(), size, input.capacity()).get(document);
+        if (!error) error = convert(document, out);
+        if (!error && !document.at_end()) error = simdjson::TRAILING_CONTENT;
+        if (error) {
+            if (errs) *errs = simdjson::error_message(error);
+            return false;
+        }
+        return true;
+    }
+
+    static std::string serialize(const Json::Value &value, JsonOutputStyle style) {
+        return JsoncppCodec::serialize(value, style);
+    }
+
+    // 把文档或值转换为 Json::Value。整数与 jsoncpp 一样按有无符号存放，超出 64 位的整数存为浮点数
+    template<typename Source>
+    static simdjson::error_code convert(Source &source, Json::Value &out) {
+        using simdjson::ondemand::json_type;
+        json_type type;
+        if (auto error = source.type().get(type)) return error;
+        switch (type) {
+            case json_type::object: {
+                simdjson::ondemand::object object;
+                if (auto error = source.get_object().get(object)) return error;
+                out = Json::Value(Json::objectValue);
+                for (auto field: object) {
+                    std::string_view key;
+                    simdjson::ondemand::value member;
+                    if (auto error = field.unescaped_key().get(key)) return error;
+                    if (auto error = field.value().get(member)) return error;
+                    if (auto error = convert(member, *out.demand(key.data(), key.data() + key.size()))) return error;
+                }
+                return simdjson::SUCCESS;
+            }
+            case json_type::array: {
+                simdjson::ondemand::array array;
+                if (auto error = source.get_array().get(array)) return error;
+                out = Json::Value(Json::arrayValue);
+                for (auto element: array) {
+                    simdjson::ondemand::value item;
+                    if (auto error = element.get(item)) return error;
+                    if (auto error = convert(item, out.append(Json::Value()))) return error;
+                }
+                return simdjson::SUCCESS;
+            }
+            case json_type::string: {
+                std::string_view text;
+                if (auto error = source.get_string().get(text)) return error;
+                out = Json::Value(text.data(), text.data() + text.size());
+                return simdjson::SUCCESS;
+            }
+            case json_type::boolean: {
+                bool flag = false;
+                if (auto error = source.get_bool().get(flag)) return error;
+                out = flag;
+                return simdjson::SUCCESS;
+            }
+            case json_type::null: {
+                bool isNull = false;
+                if (auto error = source.is_null().get(isNull)) return error;
+                if (!isNull) return simdjson::N_ATOM_ERROR;
+                out = Json::Value();
+                return simdjson::SUCCESS;
+            }
+            case json_type::number:
+                return convertNumber(source, out);
+            default:
+                return simdjson::INCORRECT_TYPE;
+        }
+    }
+
+private:
+    template<typename Source>
+    static simdjson::error_code convertNumber(Source &source, Json::Value &out) {
+        using simdjson::ondemand::number_type;
+        number_type kind;
+        if (auto error = source.get_number_type().get(kind)) return error;
+        if (kind == number_type::signed_integer) {
+            int64_t number = 0;
+            if (auto error = source.get_int64().get(number)) return error;
+            out = Json::Value(static_cast<Json::Int64>(number));
+        } else if (kind == number_type::unsigned_integer) {
+            uint64_t number = 0;
+            if (auto error = source.get_uint64().get(number)) return error;
+            out = Json::Value(static_cast<Json::UInt64>(number));
+        } else {
+            double number = 0;
+            if (auto error = source.get_double().get(number)) return error;
+            out = number;
+        }
+        return simdjson::SUCCESS;
+    }
+};
+
+using JsonCodec = SimdjsonCodec;
+#else
+using JsonCodec = JsoncppCodec;
+#endif
+
+#endif // JSON_RPC_CODEC_H
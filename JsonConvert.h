@@ -0,0 +1,428 @@
+//
+// 参数与返回值在 Json::Value 和 C++ 类型之间的转换，按类型在编译期选定，不支持的类型直接编译失败。
+// 启用 simdjson 时另有 JsonViewConverter，直接从解析器视图解码参数
+//
+
+#ifndef JSON_RPC_CONVERT_H
+#define JSON_RPC_CONVERT_H
+
+#include <jsoncpp/json/json.h>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#ifdef JSONRPC_USE_SIMDJSON
+#include <array>
+#include <cmath>
+#include "JsonCodec.h"
+#endif
+
+// 结构体字段表，由 JSONRPC_REFLECT 特化
+template<typename T>
+struct JsonReflect;
+
+template<typename T>
+concept JsonReflected = requires { JsonReflect<T>::fields; };
+
+// 解码失败统一抛出 std::invalid_argument，服务器据此返回 -32602
+template<typename T>
+struct JsonConverter {
+    static_assert(sizeof(T) == 0,
+                  "unsupported JSON-RPC parameter/return type: use JSONRPC_REFLECT or specialize JsonConverter");
+};
+
+template<>
+struct JsonConverter<Json::Value> {
+    static const Json::Value &decode(const Json::Value &value) { return value; }
+
+    static Json::Value encode(Json::Value value) { return value; }
+};
+
+template<>
+struct JsonConverter<bool> {
+    static bool decode(const Json::Value &value) {
+        if (!value.isBool()) throw std::invalid_argument("expected boolean");
+        return value.asBool();
+    }
+
+    static Json::Value encode(bool value) { return value; }
+};
+
+template<std::integral T> requires (!std::same_as<T, bool>)
+struct JsonConverter<T> {
+    static T decode(const Json::Value &value) {
+        if constexpr (std::is_signed_v<T>) {
+            if (!value.isInt64()) throw std::invalid_argument("expected integer");
+            Json::Int64 number = value.asInt64();
+            if (number < std::numeric_limits<T>::min() || number > std::numeric_limits<T>::max()) {
+                throw std::invalid_argument("integer out of range");
+            }
+            return static_cast<T>(number);
+        } else {
+            if (!value.isUInt64()) throw std::invalid_argument("expected unsigned integer");
+            Json::UInt64 number = value.asUInt64();
+            if (number > std::numeric_limits<T>::max()) {
+                throw std::invalid_argument("integer out of range");
+            }
+            return static_cast<T>(number);
+        }
+    }
+
+    static Json::Value encode(T value) {
+        if constexpr (std::is_signed_v<T>) {
+            return Json::Value(static_cast<Json::Int64>(value));
+        } else {
+            return Json::Value(static_cast<Json::UInt64>(value));
+        }
+    }
+};
+
+template<std::floating_point T>
+struct JsonConverter<T> {
+    static T decode(const Json::Value &value) {
+        if (!value.isNumeric()) throw std::invalid_argument("expected number");
+        return static_cast<T>(value.asDouble());
+    }
+
+    static Json::Value encode(T value) { return Json::Value(static_cast<double>(value)); }
+};
+
+template<>
+struct JsonConverter<std::string> {
+    static std::string decode(const Json::Value &value) {
+        if (!value.isString()) throw std::invalid_argument("expected string");
+        return value.asString();
+    }
+
+    static Json::Value encode(const std::string &value) { return value; }
+};
+
+// 指向请求中的字符串，只在本次调用期间有效
+template<>
+struct JsonConverter<std::string_view> {
+    static std::string_view decode(const Json::Value &value) {
+        const char *begin = nullptr;
+        const char *end = nullptr;
+        if (!value.getString(&begin, &end)) throw std::invalid_argument("expected string");
+        return {begin, static_cast<size_t>(end - begin)};
+    }
+
+    static Json::Value encode(std::string_view value) { return Json::Value(value.data(), value.data() + value.size()); }
+};
+
+// 只能作为返回值
+template<>
+struct JsonConverter<const char *> {
+    static Json::Value encode(const char *value) { return value; }
+};
+
+template<typename T>
+struct JsonConverter<std::vector<T>> {
+    static std::vector<T> decode(const Json::Value &value) {
+        if (!value.isArray()) throw std::invalid_argument("expected array");
+        std::vector<T> result;
+        result.reserve(value.size());
+        for (const auto &element: value) {
+            result.push_back(JsonConverter<T>::decode(element));
+        }
+        return result;
+    }
+
+    static Json::Value encode(const std::vector<T> &value) {
+        Json::Value result(Json::arrayValue);
+        for (const auto &element: value) {
+            result.append(JsonConverter<T>::encode(element));
+        }
+        return result;
+    }
+};
+
+template<typename T>
+struct JsonConverter<std::optional<T>> {
+    static std::optional<T> decode(const Json::Value &value) {
+        if (value.isNull()) return std::nullopt;
+        return JsonConverter<T>::decode(value);
+    }
+
+    static Json::Value encode(const std::optional<T> &value) {
+        return value ? JsonConverter<T>::encode(*value) : Json::Value();
+    }
+};
+
+template<JsonReflected T>
+struct JsonConverter<T> {
+    static T decode(const Json::Value &value) {
+        if (!value.isObject()) throw std::invalid_argument("expected object");
+        T result{};
+        std::apply([&](const auto &...field) { (decodeField(value, result, field), ...); }, JsonReflect<T>::fields);
+        return result;
+    }
+
+    static Json::Value encode(const T &value) {
+        Json::Value result(Json::objectValue);
+        std::apply([&](const auto &...field) {
+            ((result[field.first] = JsonConverter<std::remove_cvref_t<decltype(value.*(field.second))>>::encode(
+                    value.*(field.second))), ...);
+        }, JsonReflect<T>::fields);
+        return result;
+    }
+
+private:
+    template<typename Field>
+    static void decodeField(const Json::Value &value, T &result, const Field &field) {
+        using FieldType = std::remove_cvref_t<decltype(result.*(field.second))>;
+        const char *name = field.first;
+        const Json::Value *member = value.find(name, name + std::char_traits<char>::length(name));
+        try {
+            result.*(field.second) = JsonConverter<FieldType>::decode(member ? *member : Json::Value::nullSingleton());
+        } catch (const std::invalid_argument &e) {
+            throw std::invalid_argument(std::string(name) + ": " + e.what());
+        }
+    }
+};
+
+template<typename T>
+decltype(auto) fromJson(const Json::Value &value) {
+    return JsonConverter<std::remove_cvref_t<T>>::decode(value);
+}
+
+template<typename T>
+Json::Value toJson(T &&value) {
+    return JsonConverter<std::decay_t<T>>::encode(std::forward<T>(value));
+}
+
+#ifdef JSONRPC_USE_SIMDJSON
+// 请求中 "params" 的 simdjson on-demand 视图，value 为空表示请求没有 "params"。视图只能顺序读取一遍
+struct JsonParamsView {
+    simdjson::ondemand::value *value = nullptr;
+};
+
+// 从解析器视图解码，接受的输入与错误信息同 JsonConverter::decode。
+// 没有视图版本的类型（例如自行特化的 JsonConverter）先转换为 Json::Value 再解码
+template<typename T>
+struct JsonViewConverter {
+    static T decode(simdjson::ondemand::value &value) {
+        Json::Value json;
+        if (SimdjsonCodec::convert(value, json)) throw std::invalid_argument("malformed JSON");
+        return JsonConverter<T>::decode(json);
+    }
+};
+
+template<>
+struct JsonViewConverter<Json::Value> {
+    static Json::Value decode(simdjson::ondemand::value &value) {
+        Json::Value json;
+        if (SimdjsonCodec::convert(value, json)) throw std::invalid_argument("malformed JSON");
+        return json;
+    }
+};
+
+template<>
+struct JsonViewConverter<bool> {
+    static bool decode(simdjson::ondemand::value &value) {
+        bool result = false;
+        if (value.get_bool().get(result)) throw std::invalid_argument("expected boolean");
+        return result;
+    }
+};
+
+// 与 jsoncpp 的 isInt64/isUInt64 一致，值为整数的浮点数同样接受
+template<std::integral T> requires (!std::same_as<T, bool>)
+struct JsonViewConverter<T> {
+    static T decode(simdjson::ondemand::value &value) {
+        using simdjson::ondemand::number_type;
+        simdjson::ondemand::number number;
+        if constexpr (std::is_signed_v<T>) {
+            if (value.get_number().get(number)) throw std::invalid_argument("expected integer");
+            int64_t integer = 0;
+            if (number.get_number_type() == number_type::signed_integer) {
+                integer = number.get_int64();
+            } else if (number.get_number_type() == number_type::floating_point_number &&
+                       isIntegral(number.get_double(), -0x1p63, 0x1p63)) {
+                integer = static_cast<int64_t>(number.get_double());
+            } else {
+                throw std::invalid_argument("expected integer");
+            }
+            if (integer < std::numeric_limits<T>::min() || integer > std::numeric_limits<T>::max()) {
+                throw std::invalid_argument("integer out of range");
+            }
+            return static_cast<T>(integer);
+        } else {
+            if (value.get_number().get(number)) throw std::invalid_argument("expected unsigned integer");
+            uint64_t integer = 0;
+            if (number.get_number_type() == number_type::unsigned_integer) {
+                integer = number.get_uint64();
+            } else if (number.get_number_type() == number_type::signed_integer && number.get_int64() >= 0) {
+                integer = static_cast<uint64_t>(number.get_int64());
+            } else if (number.get_number_type() == number_type::floating_point_number &&
+                       isIntegral(number.get_double(), 0, 0x1p64)) {
+                integer = static_cast<uint64_t>(number.get_double());
+            } else {
+                throw std::invalid_argument("expected unsigned integer");
+            }
+            if (integer > std::numeric_limits<T>::max()) {
+                throw std::invalid_argument("integer out of range");
+            }
+            return static_cast<T>(integer);
+        }
+    }
+
+private:
+    static bool isIntegral(double number, double min, double limit) {
+        return number >= min && number < limit && std::trunc(number) == number;
+    }
+};
+
+template<std::floating_point T>
+struct JsonViewConverter<T> {
+    static T decode(simdjson::ondemand::value &value) {
+        double number = 0;
+        if (value.get_double().get(number)) throw std::invalid_argument("expected number");
+        return static_cast<T>(number);
+    }
+};
+
+template<>
+struct JsonViewConverter<std::string> {
+    static std::string decode(simdjson::ondemand::value &value) {
+        std::string_view text;
+        if (value.get_string().get(text)) throw std::invalid_argument("expected string");
+        return std::string(text);
+    }
+};
+
+// 指向解析器的字符串缓冲区，只在本次调用期间有效
+template<>
+struct JsonViewConverter<std::string_view> {
+    static std::string_view decode(simdjson::ondemand::value &value) {
+        std::string_view text;
+        if (value.get_string().get(text)) throw std::invalid_argument("expected string");
+        return text;
+    }
+};
+
+template<typename T>
+struct JsonViewConverter<std::vector<T>> {
+    static std::vector<T> decode(simdjson::ondemand::value &value) {
+        simdjson::ondemand::array array;
+        if (value.get_array().get(array)) throw std::invalid_argument("expected array");
+        std::vector<T> result;
+        for (auto element: array) {
+            simdjson::ondemand::value item;
+            if (element.get(item)) throw std::invalid_argument("malformed JSON");
+            result.push_back(JsonViewConverter<T>::decode(item));
+        }
+        return result;
+    }
+};
+
+template<typename T>
+struct JsonViewConverter<std::optional<T>> {
+    static std::optional<T> decode(simdjson::ondemand::value &value) {
+        bool isNull = false;
+        if (!value.is_null().get(isNull) && isNull) return std::nullopt;
+        return JsonViewConverter<T>::decode(value);
+    }
+};
+
+// 成员按出现顺序解码，未知成员忽略，缺失的字段与 JsonConverter 一样按 null 解码
+template<JsonReflected T>
+struct JsonViewConverter<T> {
+    static T decode(simdjson::ondemand::value &value) {
+        simdjson::ondemand::object object;
+        if (value.get_object().get(object)) throw std::invalid_argument("expected object");
+        T result{};
+        std::array<bool, kFieldCount> seen{};
+        for (auto field: object) {
+            std::string_view key;
+            simdjson::ondemand::value member;
+            if (field.unescaped_key().get(key) || field.value().get(member)) {
+                throw std::invalid_argument("malformed JSON");
+            }
+            decodeMember(key, member, result, seen, std::make_index_sequence<kFieldCount>{});
+        }
+        fillMissing(result, seen, std::make_index_sequence<kFieldCount>{});
+        return result;
+    }
+
+private:
+    static constexpr std::size_t kFieldCount = std::tuple_size_v<std::remove_cvref_t<decltype(JsonReflect<T>::fields)>>;
+
+    template<std::size_t... Is>
+    static void decodeMember(std::string_view key, simdjson::ondemand::value &member, T &result,
+                             std::array<bool, kFieldCount> &seen, std::index_sequence<Is...>) {
+        (void) ((key == std::get<Is>(JsonReflect<T>::fields).first &&
+                 (decodeField(member, result, std::get<Is>(JsonReflect<T>::fields)), seen[Is] = true)) || ...);
+    }
+
+    template<std::size_t... Is>
+    static void fillMissing(T &result, const std::array<bool, kFieldCount> &seen, std::index_sequence<Is...>) {
+        ((seen[Is] ? void() : decodeNull(result, std::get<Is>(JsonReflect<T>::fields))), ...);
+    }
+
+    template<typename Field>
+    static void decodeField(simdjson::ondemand::value &member, T &result, const Field &field) {
+        using FieldType = std::remove_cvref_t<decltype(result.*(field.second))>;
+        try {
+            result.*(field.second) = JsonViewConverter<FieldType>::decode(member);
+        } catch (const std::invalid_argument &e) {
+            throw std::invalid_argument(std::string(field.first) + ": " + e.what());
+        }
+    }
+
+    template<typename Field>
+    static void decodeNull(T &result, const Field &field) {
+        using FieldType = std::remove_cvref_t<decltype(result.*(field.second))>;
+        try {
+            result.*(field.second) = JsonConverter<FieldType>::decode(Json::Value::nullSingleton());
+        } catch (const std::invalid_argument &e) {
+            throw std::invalid_argument(std::string(field.first) + ": " + e.what());
+        }
+    }
+};
+
+template<typename T>
+auto fromJsonView(simdjson::ondemand::value &value) {
+    return JsonViewConverter<std::remove_cvref_t<T>>::decode(value);
+}
+#endif
+
+// JSONRPC_REFLECT(Point, x, y) 为结构体生成按字段名编解码的转换器，需在全局命名空间使用，最多 16 个字段
+#define JSONRPC_EXPAND(x) x
+#define JSONRPC_FIELD(T, f) std::pair<const char *, decltype(&T::f)>{#f, &T::f}
+#define JSONRPC_FE_1(M, T, a) M(T, a)
+#define JSONRPC_FE_2(M, T, a, ...) M(T, a), JSONRPC_EXPAND(JSONRPC_FE_1(M, T, __VA_ARGS__))
+#define JSONRPC_FE_3(M, T, a, ...) M(T, a), JSONRPC_EXPAND(JSONRPC_FE_2(M, T, __VA_ARGS__))
+#define JSONRPC_FE_4(M, T, a, ...) M(T, a), JSONRPC_EXPAND(JSONRPC_FE_3(M, T, __VA_ARGS__))
+#define JSONRPC_FE_5(M, T, a, ...) M(T, a), JSONRPC_EXPAND(JSONRPC_FE_4(M, T, __VA_ARGS__))
+#define JSONRPC_FE_6(M, T, a, ...) M(T, a), JSONRPC_EXPAND(JSONRPC_FE_5(M, T, __VA_ARGS__))
+#define JSONRPC_FE_7(M, T, a, ...) M(T, a), JSONRPC_EXPAND(JSONRPC_FE_6(M, T, __VA_ARGS__))
+#define JSONRPC_FE_8(M, T, a, ...) M(T, a), JSONRPC_EXPAND(JSONRPC_FE_7(M, T, __VA_ARGS__))
+#define JSONRPC_FE_9(M, T, a, ...) M(T, a), JSONRPC_EXPAND(JSONRPC_FE_8(M, T, __VA_ARGS__))
+#define JSONRPC_FE_10(M, T, a, ...) M(T, a), JSONRPC_EXPAND(JSONRPC_FE_9(M, T, __VA_ARGS__))
+#define JSONRPC_FE_11(M, T, a, ...) M(T, a), JSONRPC_EXPAND(JSONRPC_FE_10(M, T, __VA_ARGS__))
+#define JSONRPC_FE_12(M, T, a, ...) M(T, a), JSONRPC_EXPAND(JSONRPC_FE_11(M, T, __VA_ARGS__))
+#define JSONRPC_FE_13(M, T, a, ...) M(T, a), JSONRPC_EXPAND(JSONRPC_FE_12(M, T, __VA_ARGS__))
+#define JSONRPC_FE_14(M, T, a, ...) M(T, a), JSONRPC_EXPAND(JSONRPC_FE_13(M, T, __VA_ARGS__))
+#define JSONRPC_FE_15(M, T, a, ...) M(T, a), JSONRPC_EXPAND(JSONRPC_FE_14(M, T, __VA_ARGS__))
+#define JSONRPC_FE_16(M, T, a, ...) M(T, a), JSONRPC_EXPAND(JSONRPC_FE_15(M, T, __VA_ARGS__))
+#define JSONRPC_FE_PICK(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, NAME, ...) NAME
+#define JSONRPC_FOR_EACH(M, T, ...) JSONRPC_EXPAND(JSONRPC_FE_PICK(__VA_ARGS__, \
+        JSONRPC_FE_16, JSONRPC_FE_15, JSONRPC_FE_14, JSONRPC_FE_13, JSONRPC_FE_12, JSONRPC_FE_11, \
+        JSONRPC_FE_10, JSONRPC_FE_9, JSONRPC_FE_8, JSONRPC_FE_7, JSONRPC_FE_6, JSONRPC_FE_5, \
+        JSONRPC_FE_4, JSONRPC_FE_3, JSONRPC_FE_2, JSONRPC_FE_1)(M, T, __VA_ARGS__))
+
+#define JSONRPC_REFLECT(Type, ...) \
+    template<> \
+    struct JsonReflect<Type> { \
+        static constexpr auto fields = std::make_tuple(JSONRPC_FOR_EACH(JSONRPC_FIELD, Type, __VA_ARGS__)); \
+    };
+
+#endif // JSON_RPC_CONVERT_H
@@ -5,35 +5,79 @@
 #define JSON_RPC_CLIENT_H
 
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
 #include <jsoncpp/json/json.h>
 #include <zmq.hpp>
 #include "JsonRpcProtocol.h"
+#include "ZmqMessage.h"
 
 class JsonRpcClient {
 public:
+    // 收到完整响应（包含 result 或 error）时调用，在客户端的 I/O 线程或推送监听线程上执行，不应阻塞
+    using AsyncCallback = std::function<void(const Json::Value &response)>;
+
+    JsonRpcClient();
+
+    ~JsonRpcClient();
+
+    // 使用 DEALER 套接字连接，同一连接上可以同时有任意多个未完成的请求，按关联帧匹配响应
     void connect(const std::string &ip, int port);
 
-    void send(zmq::message_t &data);
+    // 订阅服务器 enableAsyncNotify 的推送端口，需在 callAsync 之前调用。
+    // PUB/SUB 可能丢弃推送（订阅尚未生效、超过高水位），受理后迟迟未收到推送时改为轮询 getAsyncResult
+    void subscribe(const std::string &ip, int notifyPort);
+
+    // 发送请求，响应到达时完成 future；服务器返回错误时 future 抛出 std::runtime_error。
+    // 调用过 subscribe 时以推送模式发送，结果经推送端口返回，否则直接等待服务器的回复。
+    // timeout 为 0 时使用 setTimeout 的默认值；超时后以 -32004 错误响应完成
+    std::future<Json::Value> callAsync(const std::string &method, const Json::Value &params,
+                                       const std::string &userPermission = "",
+                                       std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+
+    void callAsync(const std::string &method, const Json::Value &params, AsyncCallback callback,
+                   const std::string &userPermission = "",
+                   std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+
+    // 按值接收请求，传入右值时请求缓冲区直接交给 ZMQ 发送，不再拷贝；可在多个线程中同时调用
+    std::string call(std::string call);
 
-    void recv(zmq::message_t &data);
+    // 默认的单次调用期限，0 表示不限。期限随请求以 "timeout"（毫秒）发给服务器，服务器对开始处理前已超时的请求
+    // 直接返回 -32003；客户端到期仍未收到回复时以 -32004 完成调用，之后到达的回复被丢弃
+    void setTimeout(std::chrono::milliseconds timeout) { m_timeout = timeout; }
 
-    std::string call(const std::string& call);
+    // 推送模式下受理后首次轮询的等待时间，之后每次加倍，最长 5 秒；0 表示只等推送
+    void setPollInterval(std::chrono::milliseconds interval) { m_pollInterval = interval; }
+
+    // 请求输出格式，默认紧凑格式
+    void setOutputStyle(JsonRpcProtocol::OutputStyle style) { m_outputStyle = style; }
+
+    // 请求编码，默认 JSON；服务器按请求的编码回复，响应解析时自动识别
+    void setEncoding(JsonRpcProtocol::Encoding encoding) { m_encoding = encoding; }
 
     std::string sendRequest(const std::string &method, const Json::Value &params, bool async = false,
                             const std::string& userPermission="") {
-        static int id = 1;
-        Json::Value request = JsonRpcProtocol::createRequest(method, params, id, async,userPermission);
-        id++;
-        return request.toStyledString();
+        Json::Value request = JsonRpcProtocol::createRequest(method, params, nextId(), async,userPermission);
+        // 服务器按 (client, id) 保存异步结果，不同客户端使用相同 id 不会冲突
+        request["client"] = m_clientId;
+        if (m_timeout.count() > 0) {
+            request["timeout"] = static_cast<Json::Int64>(m_timeout.count());
+        }
+        return JsonRpcProtocol::serialize(request, m_outputStyle, m_encoding);
     }
 
     Json::Value parseResponse(const std::string &responseStr) {
-        Json::CharReaderBuilder readerBuilder;
         Json::Value response;
-        std::string errs;
-
-        std::istringstream ss(responseStr);
-        if (!Json::parseFromStream(readerBuilder, ss, &response, &errs)) {
+        if (!JsonRpcProtocol::parse(responseStr, response)) {
             throw std::runtime_error("Failed to parse response");
         }
 
@@ -44,38 +88,375 @@ public:
         return response["result"];
     }
 
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // 未完成的请求，按关联号索引；关联号与客户端生成的 JSON-RPC id 取自同一计数器
+    struct Pending {
+        AsyncCallback callback;
+        std::function<void(std::string)> rawCallback;   // call(std::string) 使用，原样交回响应
+        bool pushed = false;                            // 推送模式：受理应答之后结果经推送端口到达
+        Clock::time_point deadline = Clock::time_point::max();
+        Clock::time_point pollAt = Clock::time_point::max();   // 推送模式下次轮询的时间
+        std::chrono::milliseconds pollDelay{0};
+    };
+
+    // (期限, 关联号) 的小顶堆；请求先完成时不删除，到期检查时跳过
+    using Deadline = std::pair<Clock::time_point, int>;
+
+    static constexpr std::chrono::milliseconds kMaxPollDelay = std::chrono::seconds(5);
+
+    int nextId() { return m_nextId.fetch_add(1, std::memory_order_relaxed); }
+
+    // 登记后发送 [关联号, 空帧, 请求]；空帧使单 REP 套接字的服务器同样可以处理
+    void post(int id, Pending pending, std::string request);
+
+    // I/O 线程：把各线程提交的请求转发到 DEALER，并把回复分发给对应的未完成请求
+    void pump();
+
+    void receive();
+
+    // 距最近期限或轮询时间的毫秒数，都没有时为 -1
+    long nextTimeout();
+
+    // 以 -32004 完成所有已到期的请求
+    void expire();
+
+    // 在 I/O 线程上为到了轮询时间的推送模式请求发送 getAsyncResult，回复以原关联号返回
+    void pollOverdue();
+
+    // 调用方持有 m_pendingMtx
+    void schedulePoll(int id, Pending &pending);
+
+    // 取出待确认的推送 id，附在请求的 "ack" 中使服务器删除对应的轮询备份
+    void attachAcks(Json::Value &request);
+
+    void listen(const std::string &endpoint);
+
+    // parsed 非空时为已解析的响应
+    void complete(int id, const char *data, size_t size, const Json::Value *parsed);
+
 private:
     zmq::context_t m_context;
     std::unique_ptr<zmq::socket_t> m_socket;
+    // 发送方经 inproc PUSH/PULL 把请求交给 I/O 线程，m_sendMtx 串行化对 m_sender 的使用
+    std::unique_ptr<zmq::socket_t> m_outbox;
+    std::unique_ptr<zmq::socket_t> m_sender;
+    std::mutex m_sendMtx;
+    std::string m_clientId;
+    std::atomic<int> m_nextId{1};
+    JsonRpcProtocol::OutputStyle m_outputStyle = JsonRpcProtocol::OutputStyle::Compact;
+    JsonRpcProtocol::Encoding m_encoding = JsonRpcProtocol::Encoding::Json;
+    std::thread m_pump;
+    std::thread m_listener;
+    std::mutex m_pendingMtx;
+    std::unordered_map<int, Pending> m_pending;
+    std::priority_queue<Deadline, std::vector<Deadline>, std::greater<>> m_deadlines;
+    std::priority_queue<Deadline, std::vector<Deadline>, std::greater<>> m_polls;
+    std::vector<int> m_acks;
+    std::chrono::milliseconds m_timeout{0};
+    std::chrono::milliseconds m_pollInterval{500};
 };
 
-void JsonRpcClient::connect(const std::string &ip, int port) {
-    m_socket = std::make_unique<zmq::socket_t>(m_context, ZMQ_REQ);
+inline JsonRpcClient::JsonRpcClient() {
+    std::random_device rd;
+    std::ostringstream os;
+    os << std::hex << rd() << rd();
+    m_clientId = os.str();
+}
+
+inline JsonRpcClient::~JsonRpcClient() {
+    // 关闭上下文使 I/O 线程与推送监听线程以 ETERM 退出，未完成请求的 future 随 m_pending 析构得到 broken_promise
+    m_context.shutdown();
+    if (m_pump.joinable()) {
+        m_pump.join();
+    }
+    if (m_listener.joinable()) {
+        m_listener.join();
+    }
+}
+
+inline void JsonRpcClient::connect(const std::string &ip, int port) {
+    if (m_socket) {
+        throw std::runtime_error("Client already connected");
+    }
+    m_socket = std::make_unique<zmq::socket_t>(m_context, ZMQ_DEALER);
     std::ostringstream os;
     os << "tcp://" << ip << ":" << port;
     m_socket->connect(os.str());
+    std::string outboxAddr = "inproc://jsonrpc-client-" + m_clientId;
+    m_outbox = std::make_unique<zmq::socket_t>(m_context, ZMQ_PULL);
+    m_outbox->bind(outboxAddr);
+    m_sender = std::make_unique<zmq::socket_t>(m_context, ZMQ_PUSH);
+    m_sender->connect(outboxAddr);
+    m_pump = std::thread(&JsonRpcClient::pump, this);
 }
 
-void JsonRpcClient::send(zmq::message_t &data) {
-    zmq::send_flags flag = zmq::send_flags::dontwait;
-    m_socket->send(data, flag);
+inline void JsonRpcClient::post(int id, Pending pending, std::string request) {
+    if (!m_sender) {
+        throw std::runtime_error("Client not connected");
+    }
+    {
+        // 先登记再发送，回复可能在 send 返回前到达
+        std::lock_guard<std::mutex> lock(m_pendingMtx);
+        if (pending.deadline != Clock::time_point::max()) {
+            m_deadlines.emplace(pending.deadline, id);
+        }
+        m_pending[id] = std::move(pending);
+    }
+    try {
+        std::lock_guard<std::mutex> lock(m_sendMtx);
+        m_sender->send(zmq::message_t(&id, sizeof id), zmq::send_flags::sndmore);
+        m_sender->send(zmq::message_t(), zmq::send_flags::sndmore);
+        m_sender->send(takeMessage(std::move(request)), zmq::send_flags::none);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(m_pendingMtx);
+        m_pending.erase(id);
+        throw;
+    }
 }
 
-void JsonRpcClient::recv(zmq::message_t &data) {
-    m_socket->recv(data);
+inline void JsonRpcClient::pump() {
+    zmq::pollitem_t items[] = {
+            {static_cast<void *>(*m_outbox), 0, ZMQ_POLLIN, 0},
+            {static_cast<void *>(*m_socket), 0, ZMQ_POLLIN, 0},
+    };
+    while (true) {
+        try {
+            // 新请求经 m_outbox 到达时 poll 会返回，届时按新的最近期限重新计算等待时间
+            zmq::poll(items, 2, std::chrono::milliseconds{nextTimeout()});
+            if (items[0].revents & ZMQ_POLLIN) {
+                bool more = true;
+                while (more) {
+                    zmq::message_t frame;
+                    if (!m_outbox->recv(frame, zmq::recv_flags::dontwait)) break;
+                    more = frame.more();
+                    m_socket->send(frame, more ? zmq::send_flags::sndmore : zmq::send_flags::none);
+                }
+            }
+            if (items[1].revents & ZMQ_POLLIN) {
+                receive();
+            }
+            expire();
+            pollOverdue();
+        } catch (const zmq::error_t &e) {
+            if (e.num() == ETERM) break;
+            std::cerr << "JsonRpcClient I/O error: " << e.what() << std::endl;
+        }
+    }
+}
+
+inline void JsonRpcClient::receive() {
+    // 回复为 [关联号, 空帧, 响应]，取首帧作关联号、末帧作响应
+    zmq::message_t correlation;
+    if (!m_socket->recv(correlation, zmq::recv_flags::dontwait)) return;
+    zmq::message_t body;
+    bool more = correlation.more();
+    while (more) {
+        if (!m_socket->recv(body)) return;
+        more = body.more();
+    }
+    if (correlation.size() != sizeof(int)) return;
+    int id;
+    std::memcpy(&id, correlation.data(), sizeof id);
+    complete(id, body.data<char>(), body.size(), nullptr);
+}
+
+inline long JsonRpcClient::nextTimeout() {
+    std::lock_guard<std::mutex> lock(m_pendingMtx);
+    if (m_deadlines.empty() && m_polls.empty()) return -1;
+    Clock::time_point next = Clock::time_point::max();
+    if (!m_deadlines.empty()) next = m_deadlines.top().first;
+    if (!m_polls.empty()) next = std::min(next, m_polls.top().first);
+    auto remaining = next - Clock::now();
+    if (remaining <= Clock::duration::zero()) return 0;
+    // 向上取整，避免在期限前一刻反复醒来
+    return static_cast<long>(std::chrono::ceil<std::chrono::milliseconds>(remaining).count());
+}
+
+inline void JsonRpcClient::expire() {
+    std::vector<std::pair<int, Pending>> expired;
+    {
+        std::lock_guard<std::mutex> lock(m_pendingMtx);
+        Clock::time_point now = Clock::now();
+        while (!m_deadlines.empty() && m_deadlines.top().first <= now) {
+            int id = m_deadlines.top().second;
+            m_deadlines.pop();
+            auto it = m_pending.find(id);
+            if (it == m_pending.end()) continue;
+            expired.emplace_back(id, std::move(it->second));
+            m_pending.erase(it);
+        }
+    }
+    for (auto &[id, pending]: expired) {
+        Json::Value response = JsonRpcProtocol::createErrorResponse(-32004, "Request timed out", id);
+        if (pending.rawCallback) {
+            pending.rawCallback(JsonRpcProtocol::serialize(response, m_outputStyle));
+        } else {
+            pending.callback(response);
+        }
+    }
+}
+
+inline void JsonRpcClient::schedulePoll(int id, Pending &pending) {
+    if (m_pollInterval.count() <= 0) return;
+    pending.pollDelay = pending.pollDelay.count() == 0 ? m_pollInterval
+                                                       : std::min(pending.pollDelay * 2, kMaxPollDelay);
+    pending.pollAt = Clock::now() + pending.pollDelay;
+    m_polls.emplace(pending.pollAt, id);
+}
+
+inline void JsonRpcClient::pollOverdue() {
+    std::vector<int> due;
+    {
+        std::lock_guard<std::mutex> lock(m_pendingMtx);
+        Clock::time_point now = Clock::now();
+        while (!m_polls.empty() && m_polls.top().first <= now) {
+            auto [at, id] = m_polls.top();
+            m_polls.pop();
+            auto it = m_pending.find(id);
+            // 已完成或已改期的记录直接跳过
+            if (it == m_pending.end() || it->second.pollAt != at) continue;
+            it->second.pollAt = Clock::time_point::max();
+            due.push_back(id);
+        }
+    }
+    for (int id: due) {
+        Json::Value request = JsonRpcProtocol::createRequest("getAsyncResult", Json::Value(id), id, false);
+        request["client"] = m_clientId;
+        attachAcks(request);
+        m_socket->send(zmq::message_t(&id, sizeof id), zmq::send_flags::sndmore);
+        m_socket->send(zmq::message_t(), zmq::send_flags::sndmore);
+        m_socket->send(takeMessage(JsonRpcProtocol::serialize(request, m_outputStyle, m_encoding)),
+                       zmq::send_flags::none);
+    }
+}
+
+inline void JsonRpcClient::attachAcks(Json::Value &request) {
+    std::vector<int> acks;
+    {
+        std::lock_guard<std::mutex> lock(m_pendingMtx);
+        acks.swap(m_acks);
+    }
+    if (acks.empty()) return;
+    Json::Value &ack = request["ack"];
+    for (int id: acks) ack.append(id);
+}
+
+inline void JsonRpcClient::subscribe(const std::string &ip, int notifyPort) {
+    std::ostringstream os;
+    os << "tcp://" << ip << ":" << notifyPort;
+    m_listener = std::thread(&JsonRpcClient::listen, this, os.str());
+}
+
+inline void JsonRpcClient::listen(const std::string &endpoint) {
+    zmq::socket_t socket(m_context, ZMQ_SUB);
+    socket.set(zmq::sockopt::subscribe, m_clientId);
+    socket.connect(endpoint);
+    while (true) {
+        zmq::message_t topic;
+        zmq::message_t body;
+        try {
+            if (!socket.recv(topic) || !topic.more() || !socket.recv(body)) continue;
+        } catch (const zmq::error_t &e) {
+            if (e.num() == ETERM) break;
+            continue;
+        }
+        // 订阅按前缀匹配，需再确认主题完全相同
+        if (topic.to_string_view() != m_clientId) continue;
+        Json::Value response;
+        auto *begin = body.data<char>();
+        if (JsonRpcProtocol::parse(begin, begin + body.size(), response)) {
+            complete(response["id"].asInt(), begin, body.size(), &response);
+        }
+    }
+}
+
+inline void JsonRpcClient::complete(int id, const char *data, size_t size, const Json::Value *parsed) {
+    Json::Value response;
+    bool isParsed = false;
+    Pending pending;
+    {
+        std::lock_guard<std::mutex> lock(m_pendingMtx);
+        auto it = m_pending.find(id);
+        if (it == m_pending.end()) return;
+        if (it->second.pushed && parsed == nullptr) {
+            // 推送模式的回复：带 "notify": true 的受理应答之后结果经推送端口到达，继续等待（仍受期限约束），
+            // 同时安排轮询以防推送丢失；轮询得到 "Task still processing" 时推迟下次轮询。
+            // 被拒绝或服务器未开启推送时不会再有推送，回复本身就是最终响应
+            isParsed = JsonRpcProtocol::parse(data, data + size, response);
+            if (isParsed && (response["notify"].asBool() || response["result"] == "Task still processing")) {
+                schedulePoll(id, it->second);
+                return;
+            }
+        }
+        if (parsed != nullptr && it->second.pushed) {
+            // 经推送拿到的结果仍在服务器的轮询表中，随下一个请求确认
+            m_acks.push_back(id);
+        }
+        pending = std::move(it->second);
+        m_pending.erase(it);
+    }
+    if (pending.rawCallback) {
+        pending.rawCallback(std::string(data, size));
+        return;
+    }
+    if (parsed != nullptr) {
+        pending.callback(*parsed);
+        return;
+    }
+    if (!isParsed && !JsonRpcProtocol::parse(data, data + size, response)) {
+        response = JsonRpcProtocol::createErrorResponse(-32700, "Failed to parse response", id);
+    }
+    pending.callback(response);
+}
+
+inline std::future<Json::Value> JsonRpcClient::callAsync(const std::string &method, const Json::Value &params,
+                                                  const std::string &userPermission,
+                                                  std::chrono::milliseconds timeout) {
+    auto promise = std::make_shared<std::promise<Json::Value>>();
+    auto future = promise->get_future();
+    callAsync(method, params, [promise](const Json::Value &response) {
+        if (response.isMember("error")) {
+            promise->set_exception(std::make_exception_ptr(
+                    std::runtime_error(response["error"]["message"].asString())));
+        } else {
+            promise->set_value(response["result"]);
+        }
+    }, userPermission, timeout);
+    return future;
+}
+
+inline void JsonRpcClient::callAsync(const std::string &method, const Json::Value &params, AsyncCallback callback,
+                              const std::string &userPermission, std::chrono::milliseconds timeout) {
+    bool pushed = m_listener.joinable();
+    int requestId = nextId();
+    Json::Value request = JsonRpcProtocol::createRequest(method, params, requestId, pushed, userPermission);
+    request["client"] = m_clientId;
+    if (pushed) {
+        request["notify"] = true;
+        attachAcks(request);
+    }
+    Pending pending{std::move(callback), nullptr, pushed};
+    if (timeout.count() <= 0) {
+        timeout = m_timeout;
+    }
+    if (timeout.count() > 0) {
+        request["timeout"] = static_cast<Json::Int64>(timeout.count());
+        pending.deadline = Clock::now() + timeout;
+    }
+    post(requestId, std::move(pending), JsonRpcProtocol::serialize(request, m_outputStyle, m_encoding));
 }
 
-std::string JsonRpcClient::call(const std::string& call) {
-    zmq::message_t request(call.size() + 1);
-    memcpy(request.data(),call.data(),call.size());
-    send(request);
-    zmq::message_t reply;
-    recv(reply);
-    if (reply.empty()) {
-        return JsonRpcProtocol::createErrorResponse(
-                -32603,"empty response",-1).toStyledString();
+inline std::string JsonRpcClient::call(std::string call) {
+    auto promise = std::make_shared<std::promise<std::string>>();
+    auto future = promise->get_future();
+    Pending pending{nullptr, [promise](std::string response) { promise->set_value(std::move(response)); }};
+    if (m_timeout.count() > 0) {
+        pending.deadline = Clock::now() + m_timeout;
     }
-    return reply.to_string();
+    post(nextId(), std::move(pending), std::move(call));
+    return future.get();
 }
 
 #endif // JSON_RPC_CLIENT_H
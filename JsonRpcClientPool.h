@@ -0,0 +1,248 @@
+//
+// 多个服务器副本之间的客户端连接池：可选的负载均衡策略、超时摘除与幂等请求的透明重试
+//
+
+#ifndef JSON_RPC_CLIENT_POOL_H
+#define JSON_RPC_CLIENT_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "JsonRpcClient.h"
+
+enum class LoadBalancing {
+    RoundRobin,         // 依次轮转
+    LeastOutstanding,   // 未完成请求最少的端点
+    Ewma                // 延迟的指数加权平均乘以 (未完成请求数 + 1) 最小的端点，尚无样本的端点优先
+};
+
+class JsonRpcClientPool {
+public:
+    struct EndpointStats {
+        std::string endpoint;
+        size_t outstanding;
+        int64_t ewmaMicros;     // 延迟的指数加权平均，0 表示尚无样本
+        uint64_t requests;
+        uint64_t failures;      // 超时或连接失败次数
+        bool ejected;
+    };
+
+    explicit JsonRpcClientPool(LoadBalancing balancing = LoadBalancing::RoundRobin) : m_balancing(balancing) {}
+
+    // 每个端点一条流水线连接，需在 call 之前添加
+    void addEndpoint(const std::string &ip, int port);
+
+    // 单次尝试的超时时间，默认 1 秒
+    void setTimeout(std::chrono::milliseconds timeout) { m_timeout = timeout; }
+
+    // 幂等请求最多尝试 maxAttempts 次，重试时优先换用其他端点
+    void setRetry(int maxAttempts) { m_maxAttempts = maxAttempts > 0 ? maxAttempts : 1; }
+
+    // 连续失败 failures 次的端点在 duration 内不再被选中，之后重新参与均衡
+    void setEjection(int failures, std::chrono::milliseconds duration) {
+        m_ejectAfter = failures > 0 ? failures : 1;
+        m_ejectionTime = duration;
+    }
+
+    // 返回 result，服务器返回错误时抛出 std::runtime_error。idempotent 为 true 时超时或连接失败会在其他端点重试；
+    // 服务器以 -32002 拒绝的请求未被执行，无论是否幂等都会重试
+    Json::Value call(const std::string &method, const Json::Value &params, bool idempotent = false,
+                     const std::string &userPermission = "");
+
+    std::vector<EndpointStats> stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Endpoint {
+        std::string address;
+        std::atomic<size_t> outstanding{0};
+        std::atomic<int64_t> ewmaMicros{0};
+        std::atomic<int> consecutiveFailures{0};
+        std::atomic<int64_t> ejectedUntil{0};      // Clock 的 tick 数
+        std::atomic<uint64_t> requests{0};
+        std::atomic<uint64_t> failures{0};
+        // 最后声明、最先析构：先停掉 I/O 线程，之后不会再有回调访问上面的计数
+        JsonRpcClient client;
+    };
+
+    enum class Outcome {
+        Done,       // 收到响应（成功或服务器错误）
+        Busy,       // 服务器拒绝受理，可安全重试
+        Failed      // 超时或连接失败，请求可能已被执行
+    };
+
+    // tried 中的端点尽量不再选；所有端点都被摘除时退回到全部端点中选择
+    Endpoint &pick(const std::vector<Endpoint *> &tried);
+
+    Outcome attempt(Endpoint &endpoint, const std::string &method, const Json::Value &params,
+                    const std::string &userPermission, Json::Value &response);
+
+    void recordSuccess(Endpoint &endpoint, Clock::duration latency);
+
+    void recordFailure(Endpoint &endpoint);
+
+    static bool isEjected(const Endpoint &endpoint, Clock::time_point now) {
+        return endpoint.ejectedUntil.load(std::memory_order_relaxed) > now.time_since_epoch().count();
+    }
+
+private:
+    std::vector<std::unique_ptr<Endpoint>> m_endpoints;
+    LoadBalancing m_balancing;
+    std::atomic<size_t> m_next{0};
+    std::chrono::milliseconds m_timeout{1000};
+    int m_maxAttempts = 2;
+    int m_ejectAfter = 3;
+    std::chrono::milliseconds m_ejectionTime{5000};
+};
+
+inline void JsonRpcClientPool::addEndpoint(const std::string &ip, int port) {
+    auto endpoint = std::make_unique<Endpoint>();
+    endpoint->address = ip + ":" + std::to_string(port);
+    endpoint->client.connect(ip, port);
+    m_endpoints.push_back(std::move(endpoint));
+}
+
+inline Json::Value JsonRpcClientPool::call(const std::string &method, const Json::Value &params, bool idempotent,
+                                    const std::string &userPermission) {
+    if (m_endpoints.empty()) {
+        throw std::runtime_error("No endpoints");
+    }
+    std::vector<Endpoint *> tried;
+    Json::Value response;
+    for (int i = 0; i < m_maxAttempts; ++i) {
+        Endpoint &endpoint = pick(tried);
+        tried.push_back(&endpoint);
+        Outcome outcome = attempt(endpoint, method, params, userPermission, response);
+        if (outcome == Outcome::Done) {
+            break;
+        }
+        if (outcome == Outcome::Failed && !idempotent) {
+            throw std::runtime_error("Request to " + endpoint.address + " timed out");
+        }
+    }
+    if (response.isNull()) {
+        throw std::runtime_error("Request timed out");
+    }
+    if (response.isMember("error")) {
+        throw std::runtime_error(response["error"]["message"].asString());
+    }
+    return response["result"];
+}
+
+inline JsonRpcClientPool::Outcome JsonRpcClientPool::attempt(Endpoint &endpoint, const std::string &method,
+                                                      const Json::Value &params, const std::string &userPermission,
+                                                      Json::Value &response) {
+    auto promise = std::make_shared<std::promise<Json::Value>>();
+    std::future<Json::Value> future = promise->get_future();
+    endpoint.requests.fetch_add(1, std::memory_order_relaxed);
+    endpoint.outstanding.fetch_add(1, std::memory_order_relaxed);
+    Clock::time_point start = Clock::now();
+    try {
+        // 期限由客户端执行，到期时回调收到 -32004，计数在回调里归还
+        Endpoint *target = &endpoint;
+        endpoint.client.callAsync(method, params, [promise, target](const Json::Value &reply) {
+            target->outstanding.fetch_sub(1, std::memory_order_relaxed);
+            promise->set_value(reply);
+        }, userPermission, m_timeout);
+    } catch (const std::exception &) {
+        endpoint.outstanding.fetch_sub(1, std::memory_order_relaxed);
+        recordFailure(endpoint);
+        return Outcome::Failed;
+    }
+    try {
+        response = future.get();
+    } catch (const std::exception &) {
+        recordFailure(endpoint);
+        return Outcome::Failed;
+    }
+    if (response.isMember("error") && response["error"]["code"].asInt() == -32004) {
+        recordFailure(endpoint);
+        return Outcome::Failed;
+    }
+    recordSuccess(endpoint, Clock::now() - start);
+    if (response.isMember("error") && response["error"]["code"].asInt() == -32002) {
+        return Outcome::Busy;
+    }
+    return Outcome::Done;
+}
+
+inline JsonRpcClientPool::Endpoint &JsonRpcClientPool::pick(const std::vector<Endpoint *> &tried) {
+    Clock::time_point now = Clock::now();
+    // 依次放宽条件：未摘除且未尝试过 -> 未摘除 -> 任意端点
+    for (int pass = 0; pass < 3; ++pass) {
+        Endpoint *best = nullptr;
+        uint64_t bestScore = std::numeric_limits<uint64_t>::max();
+        size_t count = m_endpoints.size();
+        size_t offset = m_next.fetch_add(1, std::memory_order_relaxed);
+        for (size_t i = 0; i < count; ++i) {
+            Endpoint *endpoint = m_endpoints[(offset + i) % count].get();
+            if (pass < 2 && isEjected(*endpoint, now)) continue;
+            if (pass == 0 && std::find(tried.begin(), tried.end(), endpoint) != tried.end()) continue;
+            uint64_t score = 0;
+            size_t outstanding = endpoint->outstanding.load(std::memory_order_relaxed);
+            switch (m_balancing) {
+                case LoadBalancing::RoundRobin:
+                    return *endpoint;
+                case LoadBalancing::LeastOutstanding:
+                    score = outstanding;
+                    break;
+                case LoadBalancing::Ewma:
+                    score = static_cast<uint64_t>(endpoint->ewmaMicros.load(std::memory_order_relaxed)) *
+                            (outstanding + 1);
+                    break;
+            }
+            // 从轮转位置开始扫描，得分相同的端点之间也能分摊请求
+            if (score < bestScore) {
+                best = endpoint;
+                bestScore = score;
+            }
+        }
+        if (best != nullptr) return *best;
+    }
+    return *m_endpoints.front();
+}
+
+inline void JsonRpcClientPool::recordSuccess(Endpoint &endpoint, Clock::duration latency) {
+    endpoint.consecutiveFailures.store(0, std::memory_order_relaxed);
+    int64_t sample = std::chrono::duration_cast<std::chrono::microseconds>(latency).count() + 1;
+    int64_t current = endpoint.ewmaMicros.load(std::memory_order_relaxed);
+    int64_t updated;
+    do {
+        // 衰减系数 1/5，首个样本直接作为初值
+        updated = current == 0 ? sample : current + (sample - current) / 5;
+    } while (!endpoint.ewmaMicros.compare_exchange_weak(current, updated, std::memory_order_relaxed));
+}
+
+inline void JsonRpcClientPool::recordFailure(Endpoint &endpoint) {
+    endpoint.failures.fetch_add(1, std::memory_order_relaxed);
+    if (endpoint.consecutiveFailures.fetch_add(1, std::memory_order_relaxed) + 1 >= m_ejectAfter) {
+        endpoint.consecutiveFailures.store(0, std::memory_order_relaxed);
+        Clock::time_point until = Clock::now() + m_ejectionTime;
+        endpoint.ejectedUntil.store(until.time_since_epoch().count(), std::memory_order_relaxed);
+        // 恢复后按慢端点对待，由新的样本重新估计
+        endpoint.ewmaMicros.store(
+                std::chrono::duration_cast<std::chrono::microseconds>(m_timeout).count(), std::memory_order_relaxed);
+    }
+}
+
+inline std::vector<JsonRpcClientPool::EndpointStats> JsonRpcClientPool::stats() const {
+    std::vector<EndpointStats> result;
+    Clock::time_point now = Clock::now();
+    for (const auto &endpoint: m_endpoints) {
+        result.push_back({endpoint->address, endpoint->outstanding.load(std::memory_order_relaxed),
+                          endpoint->ewmaMicros.load(std::memory_order_relaxed),
+                          endpoint->requests.load(std::memory_order_relaxed),
+                          endpoint->failures.load(std::memory_order_relaxed), isEjected(*endpoint, now)});
+    }
+    return result;
+}
+
+#endif // JSON_RPC_CLIENT_POOL_H
@@ -7,27 +7,58 @@
 
 #include <jsoncpp/json/json.h>
 #include <string>
-template<typename T>
-T fromJson(const Json::Value& value) {
-    // 这里可以根据 T 的类型决定如何从 Json::Value 中提取
-    if constexpr (std::is_same_v<T, int>) {
-        return value.asInt();
-    } else if constexpr (std::is_same_v<T, std::string>) {
-        return value.asString();
-    }
-    // 可以添加更多类型支持
-}
-
+#include "JsonCodec.h"
+#include "MsgPackCodec.h"
+#include "JsonConvert.h"
 
 class JsonRpcProtocol {
 public:
-    static Json::Value createRequest(const std::string& method, const Json::Value& params, int id,bool async) {
+    using OutputStyle = JsonOutputStyle;
+
+    // 线上编码：MessagePack 负载以首字节区分（>= 0x80），两种编码承载相同的 JSON-RPC 信封
+    enum class Encoding {
+        Json,
+        MsgPack
+    };
+
+    static Encoding detectEncoding(const char* begin, const char* end) {
+        return MsgPackCodec::isMsgPack(begin, end) ? Encoding::MsgPack : Encoding::Json;
+    }
+
+    // 解析 [begin, end) 区间，按首字节自动识别编码；JSON 后端由构建选项决定（见 JsonCodec.h）
+    static bool parse(const char* begin, const char* end, Json::Value& out, std::string* errs = nullptr) {
+        if (MsgPackCodec::isMsgPack(begin, end)) {
+            return MsgPackCodec::parse(begin, end, out, errs);
+        }
+        return JsonCodec::parse(begin, end, out, errs);
+    }
+
+    static bool parse(const std::string& str, Json::Value& out, std::string* errs = nullptr) {
+        return parse(str.data(), str.data() + str.size(), out, errs);
+    }
+
+    // style 只对 JSON 编码有效
+    static std::string serialize(const Json::Value& value, OutputStyle style = OutputStyle::Compact,
+                                 Encoding encoding = Encoding::Json) {
+        if (encoding == Encoding::MsgPack) {
+            std::string out;
+            MsgPackCodec::write(value, out);
+            return out;
+        }
+        return JsonCodec::serialize(value, style);
+    }
+
+    static Json::Value createRequest(const std::string& method, const Json::Value& params, int id,bool async,
+                                     const std::string& userPermission = "") {
         Json::Value request;
         request["jsonrpc"] = "2.0";
         request["method"] = method;
         request["params"] = params;
         request["id"] = id;
         request["async"]=async;
+        if (!userPermission.empty()) {
+            request["userPermission"] = userPermission;
+        }
         return request;
     }
 
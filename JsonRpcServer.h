@@ -10,44 +10,49 @@
 #include <future>
 #include <zmq.hpp>
 #include <thread>
+#include <vector>
+#include <atomic>
+#include <sstream>
+#include <memory>
+#include <stdexcept>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include <condition_variable>
+#include <mutex>
 
 #include "log/log.h"
+#include "log/mpmcqueue.h"
 #include "JsonRpcProtocol.h"
+#include "ThreadPool.h"
+#include "AsyncResultStore.h"
+#include "ZmqMessage.h"
+#include "DispatchTable.h"
+#include "EpochReclaimer.h"
+#include "Coroutine.h"
+#include "Metrics.h"
 
 template<typename T>
-T fromJson(const Json::Value &value);
-
-template<>
-int fromJson<int>(const Json::Value &value) {
-    return value.asInt();
-}
-
-template<>
-double fromJson<double>(const Json::Value &value) {
-    return value.asDouble();
-}
-
-template<>
-std::string fromJson<std::string>(const Json::Value &value) {
-    return value.asString();
-}
-
-
-template<typename T>
-struct function_traits;
+struct function_traits : public function_traits<decltype(&T::operator())> {
+};
 
 // 对于普通函数
 template<typename R, typename... Args>
 struct function_traits<R(Args...)> {
     using return_type = R;
 
+    using signature = R(Args...);
+
     template<std::size_t N>
     using arg = typename std::tuple_element_t<N, std::tuple<Args...>>;
 
     static constexpr std::size_t arity = sizeof...(Args);
 };
 
-// 对于 lambda 或 std::function 对象
+// 对于函数指针
 template<typename R, typename... Args>
 struct function_traits<R(*)(Args...)> : public function_traits<R(Args...)> {
 };
@@ -56,69 +61,351 @@ struct function_traits<R(*)(Args...)> : public function_traits<R(Args...)> {
 template<typename R, typename... Args>
 struct function_traits<std::function<R(Args...)>> : public function_traits<R(Args...)> {
 };
+
 // 对于成员函数
 template<typename C, typename R, typename... Args>
-struct function_traits<R(C::*)(Args...)> {
-    using return_type = R;
+struct function_traits<R(C::*)(Args...)> : public function_traits<R(Args...)> {
+    using class_type = C;
+};
 
-    template<std::size_t N>
-    using arg = typename std::tuple_element_t<N, std::tuple<Args...>>;
+// 对于 const 成员函数（包括 lambda 的 operator()）
+template<typename C, typename R, typename... Args>
+struct function_traits<R(C::*)(Args...) const> : public function_traits<R(Args...)> {
+    using class_type = C;
+};
+
+// 按名传参时的参数名表，注册时一次性构建 参数名 -> 位置 的哈希表，例如 ParamNames{"a", "b"}
+class ParamNames {
+public:
+    ParamNames(std::initializer_list<std::string> names) : m_names(names) {
+        std::vector<std::pair<std::string, std::size_t>> entries;
+        for (std::size_t i = 0; i < m_names.size(); ++i) {
+            for (std::size_t j = 0; j < i; ++j) {
+                if (m_names[j] == m_names[i]) throw std::invalid_argument("Duplicate parameter name: " + m_names[i]);
+            }
+            entries.emplace_back(m_names[i], i);
+        }
+        m_index = DispatchTable<std::size_t>(std::move(entries));
+    }
+
+    const std::size_t *find(std::string_view name) const { return m_index.find(name); }
+
+    const std::string &operator[](std::size_t i) const { return m_names[i]; }
 
+    std::size_t size() const { return m_names.size(); }
+
+private:
+    std::vector<std::string> m_names;
+    DispatchTable<std::size_t> m_index;
+};
+
+// 按函数签名生成的调用器：把第 i 个参数解码为第 i 个形参类型后调用，返回值编码为 Json::Value。
+// 不支持的参数或返回类型在实例化 JsonConverter 时编译失败
+template<typename Signature>
+struct JsonInvoker;
+
+template<typename R, typename... Args>
+struct JsonInvoker<R(Args...)> {
     static constexpr std::size_t arity = sizeof...(Args);
 
-    using class_type = C;
+    // 按位置排好的实参，按名传参时缺失的参数为空指针
+    using Arguments = std::array<const Json::Value *, arity>;
+
+    // 按位置传参。bound 为调用时放在解码参数之前的实参，例如成员函数的对象指针
+    template<typename Callable, typename... Bound>
+    static Json::Value call(const Json::Value &params, Callable &&callable, Bound &&... bound) {
+        return encode([&]() -> R {
+            return invoke(params, std::forward<Callable>(callable), std::forward<Bound>(bound)...);
+        });
+    }
+
+    // params 为对象时按名传参，每个成员只查一次预先构建的名字表；为数组时仍按位置传参
+    template<typename Callable, typename... Bound>
+    static Json::Value callNamed(const Json::Value &params, const ParamNames &names, Callable &&callable,
+                                 Bound &&... bound) {
+        return encode([&]() -> R {
+            return invokeNamed(params, names, std::forward<Callable>(callable), std::forward<Bound>(bound)...);
+        });
+    }
+
+    // 只解码参数并调用，返回原始结果，供返回 Task 的协程方法使用
+    template<typename Callable, typename... Bound>
+    static R invoke(const Json::Value &params, Callable &&callable, Bound &&... bound) {
+        if (!(params.isArray() || (params.isNull() && arity == 0)) || params.size() != arity) {
+            throw std::invalid_argument("Incorrect number of arguments");
+        }
+        Arguments args{};
+        for (std::size_t i = 0; i < arity; ++i) {
+            args[i] = &params[static_cast<Json::ArrayIndex>(i)];
+        }
+        return invokeWith(args, nullptr, std::index_sequence_for<Args...>{}, std::forward<Callable>(callable),
+                          std::forward<Bound>(bound)...);
+    }
+
+    template<typename Callable, typename... Bound>
+    static R invokeNamed(const Json::Value &params, const ParamNames &names, Callable &&callable, Bound &&... bound) {
+        if (!params.isObject()) {
+            return invoke(params, std::forward<Callable>(callable), std::forward<Bound>(bound)...);
+        }
+        Arguments args{};
+        for (auto it = params.begin(); it != params.end(); ++it) {
+            const char *end = nullptr;
+            const char *begin = it.memberName(&end);
+            const std::size_t *index = names.find({begin, static_cast<size_t>(end - begin)});
+            if (index == nullptr) {
+                throw std::invalid_argument("Unknown parameter: " + std::string(begin, end));
+            }
+            args[*index] = &*it;
+        }
+        return invokeWith(args, &names, std::index_sequence_for<Args...>{}, std::forward<Callable>(callable),
+                          std::forward<Bound>(bound)...);
+    }
+
+#ifdef JSONRPC_USE_SIMDJSON
+    // 以下为解析器视图版本：实参依次从视图解码，不构建 Json::Value，接受的输入与错误信息同上
+    template<typename Callable, typename... Bound>
+    static Json::Value call(JsonParamsView params, Callable &&callable, Bound &&... bound) {
+        return encode([&]() -> R {
+            return invoke(params, std::forward<Callable>(callable), std::forward<Bound>(bound)...);
+        });
+    }
+
+    template<typename Callable, typename... Bound>
+    static Json::Value callNamed(JsonParamsView params, const ParamNames &names, Callable &&callable,
+                                 Bound &&... bound) {
+        return encode([&]() -> R {
+            return invokeNamed(params, names, std::forward<Callable>(callable), std::forward<Bound>(bound)...);
+        });
+    }
+
+    template<typename Callable, typename... Bound>
+    static R invoke(JsonParamsView params, Callable &&callable, Bound &&... bound) {
+        simdjson::ondemand::json_type type = simdjson::ondemand::json_type::null;
+        if (params.value != nullptr && params.value->type().get(type)) {
+            throw std::invalid_argument("malformed JSON");
+        }
+        if (type == simdjson::ondemand::json_type::null) {
+            if constexpr (arity == 0) {
+                return std::invoke(std::forward<Callable>(callable), std::forward<Bound>(bound)...);
+            } else {
+                throw std::invalid_argument("Incorrect number of arguments");
+            }
+        }
+        simdjson::ondemand::array array;
+        size_t count = 0;
+        if (type != simdjson::ondemand::json_type::array || params.value->get_array().get(array) ||
+            array.count_elements().get(count) || count != arity) {
+            throw std::invalid_argument("Incorrect number of arguments");
+        }
+        simdjson::ondemand::array_iterator it;
+        if (array.begin().get(it)) throw std::invalid_argument("malformed JSON");
+        // 花括号初始化按书写顺序求值，实参依次从数组中读出
+        std::tuple<ViewArg<Args>...> args{nextArg<Args>(it)...};
+        return std::apply([&](auto &...decoded) -> R {
+            return std::invoke(std::forward<Callable>(callable), std::forward<Bound>(bound)..., std::move(decoded)...);
+        }, args);
+    }
+
+    template<typename Callable, typename... Bound>
+    static R invokeNamed(JsonParamsView params, const ParamNames &names, Callable &&callable, Bound &&... bound) {
+        simdjson::ondemand::json_type type = simdjson::ondemand::json_type::null;
+        if (params.value != nullptr && params.value->type().get(type)) {
+            throw std::invalid_argument("malformed JSON");
+        }
+        if (type != simdjson::ondemand::json_type::object) {
+            return invoke(params, std::forward<Callable>(callable), std::forward<Bound>(bound)...);
+        }
+        simdjson::ondemand::object object;
+        if (params.value->get_object().get(object)) throw std::invalid_argument("malformed JSON");
+        Slots slots;
+        for (auto field: object) {
+            std::string_view key;
+            simdjson::ondemand::value value;
+            if (field.unescaped_key().get(key) || field.value().get(value)) {
+                throw std::invalid_argument("malformed JSON");
+            }
+            const std::size_t *index = names.find(key);
+            if (index == nullptr) {
+                throw std::invalid_argument("Unknown parameter: " + std::string(key));
+            }
+            decodeSlot(slots, *index, value, names, std::index_sequence_for<Args...>{});
+        }
+        return invokeSlots(slots, names, std::index_sequence_for<Args...>{}, std::forward<Callable>(callable),
+                           std::forward<Bound>(bound)...);
+    }
+#endif
+
+private:
+#ifdef JSONRPC_USE_SIMDJSON
+    template<typename T>
+    using ViewArg = decltype(fromJsonView<T>(std::declval<simdjson::ondemand::value &>()));
+
+    // 按名传参时已读到的实参，按形参位置存放
+    using Slots = std::tuple<std::optional<ViewArg<Args>>...>;
+
+    template<typename T>
+    static ViewArg<T> nextArg(simdjson::ondemand::array_iterator &it) {
+        simdjson::ondemand::value value;
+        if ((*it).get(value)) throw std::invalid_argument("malformed JSON");
+        ViewArg<T> decoded = fromJsonView<T>(value);
+        ++it;
+        return decoded;
+    }
+
+    template<std::size_t... Is>
+    static void decodeSlot(Slots &slots, std::size_t index, simdjson::ondemand::value &value,
+                           [[maybe_unused]] const ParamNames &names, std::index_sequence<Is...>) {
+        ((Is == index ? decodeNamedArg<Args>(std::get<Is>(slots), value, names[Is]) : void()), ...);
+    }
+
+    template<typename T>
+    static void decodeNamedArg(std::optional<ViewArg<T>> &slot, simdjson::ondemand::value &value,
+                               const std::string &name) {
+        try {
+            slot.emplace(fromJsonView<T>(value));
+        } catch (const std::invalid_argument &e) {
+            throw std::invalid_argument(name + ": " + e.what());
+        }
+    }
+
+    // 缺失的参数与 Json::Value 版本一样按 null 解码
+    template<typename T>
+    static ViewArg<T> takeSlot(std::optional<ViewArg<T>> &slot, const ParamNames &names, std::size_t i) {
+        if (slot) return std::move(*slot);
+        return decodeArg<T>(Arguments{}, i, &names);
+    }
+
+    template<std::size_t... Is, typename Callable, typename... Bound>
+    static R invokeSlots(Slots &slots, [[maybe_unused]] const ParamNames &names, std::index_sequence<Is...>,
+                         Callable &&callable, Bound &&... bound) {
+        return std::invoke(std::forward<Callable>(callable), std::forward<Bound>(bound)...,
+                           takeSlot<Args>(std::get<Is>(slots), names, Is)...);
+    }
+#endif
+
+    template<typename F>
+    static Json::Value encode(F &&invocation) {
+        if constexpr (std::is_void_v<R>) {
+            invocation();
+            return {};
+        } else {
+            return toJson(invocation());
+        }
+    }
+
+    template<typename T>
+    static decltype(auto) decodeArg(const Arguments &args, std::size_t i, const ParamNames *names) {
+        const Json::Value &value = args[i] ? *args[i] : Json::Value::nullSingleton();
+        if (names == nullptr) {
+            return fromJson<T>(value);
+        }
+        try {
+            return fromJson<T>(value);
+        } catch (const std::invalid_argument &e) {
+            throw std::invalid_argument((*names)[i] + ": " + e.what());
+        }
+    }
+
+    template<std::size_t... Is, typename Callable, typename... Bound>
+    static R invokeWith(const Arguments &args, [[maybe_unused]] const ParamNames *names,
+                        std::index_sequence<Is...>,
+                        Callable &&callable, Bound &&... bound) {
+        return std::invoke(std::forward<Callable>(callable), std::forward<Bound>(bound)...,
+                           decodeArg<Args>(args, Is, names)...);
+    }
 };
 
-// 用于从 Json::Value 中提取参数，并将其传递给成员函数
-template<typename Instance, typename Func, typename... Args, std::size_t... Is>
-auto invokeWithJsonImpl(Instance *instance, Func func, const Json::Value &params, std::index_sequence<Is...>) {
-    // 使用索引展开，将 JSON 中的参数逐个传递给 fromJson
-    return (instance->*func)(fromJson<Args>(params[(int) Is])...);
+// 把协程方法的结果编码为 Json::Value；params 持有解码出的 string_view 等参数所引用的请求数据，随协程帧一起释放
+template<typename T>
+Task<Json::Value> encodeTask(Task<T> task, [[maybe_unused]] std::shared_ptr<const Json::Value> params) {
+    if constexpr (std::is_void_v<T>) {
+        co_await task;
+        co_return Json::Value();
+    } else {
+        co_return toJson(co_await task);
+    }
 }
 
-// 普通函数的实现
-template<typename Func, typename... Args, std::size_t... Is>
-auto invokeWithJsonImpl(Func func, const Json::Value &params, std::index_sequence<Is...>) {
-    return func(fromJson<Args>(params[(int) Is])...);
-}
+// 轻量的类型擦除：一个函数指针加目标对象。编译期注册的方法没有状态，调用即为一次直接跳转。
+// 启用 simdjson 时，参数解码同样由模板生成的方法另带一个从解析器视图调用的函数指针
+class RpcMethod {
+public:
+    using Invoker = Json::Value (*)(const void *target, const Json::Value &params);
+#ifdef JSONRPC_USE_SIMDJSON
+    using ViewInvoker = Json::Value (*)(const void *target, JsonParamsView params);
+#endif
 
-// 生成索引序列，并调用 invokeWithJsonImpl
-template<typename Instance, typename Func, typename... Args>
-auto invokeWithJson(Instance *instance, Func func, const Json::Value &params) {
-    return invokeWithJsonImpl<Instance, Func, Args...>(instance, func, params, std::index_sequence_for<Args...>{});
-}
+    RpcMethod() = default;
 
-// 普通函数的实现
-template<typename Func, typename... Args>
-auto invokeWithJson(Func func, const Json::Value &params) {
-    return invokeWithJsonImpl<Func, Args...>(func, params, std::index_sequence_for<Args...>{});
-}
+    explicit RpcMethod(Invoker invoker, const void *target = nullptr, std::shared_ptr<const void> owner = nullptr)
+            : m_invoker(invoker), m_target(target), m_owner(std::move(owner)) {}
 
-// 为成员函数指针添加支持
-template<typename Instance, typename Func, std::size_t... Is>
-auto invoke(Instance *instance, Func func, const Json::Value &params, std::index_sequence<Is...>) {
-    using traits = function_traits<Func>;
-    return invokeWithJson<Instance, Func, typename traits::template arg<Is>...>(instance, func, params);
-}
+    // 运行期注册的可调用对象保存在堆上，由 m_owner 管理生命周期
+    template<typename F>
+    static RpcMethod wrap(F func) {
+        auto owner = std::make_shared<const F>(std::move(func));
+        RpcMethod method([](const void *target, const Json::Value &params) -> Json::Value {
+            return (*static_cast<const F *>(target))(params);
+        }, owner.get(), owner);
+#ifdef JSONRPC_USE_SIMDJSON
+        if constexpr (std::is_invocable_r_v<Json::Value, const F &, JsonParamsView>) {
+            method.m_viewInvoker = [](const void *target, JsonParamsView params) -> Json::Value {
+                return (*static_cast<const F *>(target))(params);
+            };
+        }
+#endif
+        return method;
+    }
 
-// 普通函数的实现
-template<typename Func, std::size_t... Is>
-auto invoke(Func func, const Json::Value &params, std::index_sequence<Is...>) {
-    using traits = function_traits<Func>;
-    return invokeWithJson<Func, typename traits::template arg<Is>...>(func, params);
-}
+    // 编译期注册：call 为无状态的 (target, params) 调用，target 原样传回
+    template<typename Call>
+    static RpcMethod bind(Call, const void *target = nullptr) {
+        static_assert(std::is_empty_v<Call>, "bind() takes a captureless callable");
+        RpcMethod method([](const void *target, const Json::Value &params) -> Json::Value {
+            return Call{}(target, params);
+        }, target);
+#ifdef JSONRPC_USE_SIMDJSON
+        method.m_viewInvoker = [](const void *target, JsonParamsView params) -> Json::Value {
+            return Call{}(target, params);
+        };
+#endif
+        return method;
+    }
+
+    Json::Value operator()(const Json::Value &params) const { return m_invoker(m_target, params); }
+
+#ifdef JSONRPC_USE_SIMDJSON
+    // 协程方法等只接受 Json::Value 的方法没有视图调用器
+    bool hasView() const { return m_viewInvoker != nullptr; }
+
+    Json::Value operator()(JsonParamsView params) const { return m_viewInvoker(m_target, params); }
+#endif
+
+private:
+    Invoker m_invoker = nullptr;
+#ifdef JSONRPC_USE_SIMDJSON
+    ViewInvoker m_viewInvoker = nullptr;
+#endif
+    const void *m_target = nullptr;
+    std::shared_ptr<const void> m_owner;
+};
 
 
 class JsonRpcServer {
 public:
 
-    using RpcMethod = std::function<Json::Value(const Json::Value &)>;
-
-    explicit JsonRpcServer() {
-        Log::Instance()->init(0);
+    explicit JsonRpcServer()
+            : m_asyncResults(std::make_unique<AsyncResultStore>()), m_executor(std::make_unique<ThreadPool>()) {
+        m_methods.store(m_methodTable.get(), std::memory_order_seq_cst);
+        // 应用已自行初始化日志（例如二进制格式）时沿用其配置
+        if (!Log::Instance()->isOpen()) {
+            Log::Instance()->init(0);
+        }
         LOG_INFO("server start")
     }
 
+    ~JsonRpcServer();
+
     void run();
 
     // 注册任意函数
@@ -130,264 +417,1326 @@ public:
     void registerMethod(const std::string &method, F func, S *s, bool overwrite = false,
                         const std::string &requiredPermission = "");
 
+    // 编译期注册：函数作为模板参数，生成专用的解码器并直接调用，例如 registerMethod<&add>("add")
+    template<auto Func>
+    void registerMethod(const std::string &method, bool overwrite = false,
+                        const std::string &requiredPermission = "");
+
+    template<auto Func, typename S>
+    void registerMethod(const std::string &method, S *s, bool overwrite = false,
+                        const std::string &requiredPermission = "");
+
+    // 按名传参：params 可以是 {"a": 1, "b": 2}，也仍可按位置传数组，例如
+    // registerMethod("add", add, ParamNames{"a", "b"})
+    template<typename F>
+    void registerMethod(const std::string &method, F func, ParamNames paramNames, bool overwrite = false,
+                        const std::string &requiredPermission = "");
+
+    template<typename F, typename S>
+    void registerMethod(const std::string &method, F func, S *s, ParamNames paramNames, bool overwrite = false,
+                        const std::string &requiredPermission = "");
+
+    template<auto Func>
+    void registerMethod(const std::string &method, ParamNames paramNames, bool overwrite = false,
+                        const std::string &requiredPermission = "");
+
+    template<auto Func, typename S>
+    void registerMethod(const std::string &method, S *s, ParamNames paramNames, bool overwrite = false,
+                        const std::string &requiredPermission = "");
+
     bool send(zmq::message_t &data);
 
     bool recv(zmq::message_t &data);
 
-    void as_server(int port);
+    // workerCount 为 0 时使用单个 REP 套接字；大于 0 时前端为 ROUTER，请求经 inproc DEALER 分发给 workerCount 个工作线程
+    // 单 REP 套接字模式下请求期限从读出请求时算起，不含在 ZMQ 缓冲中排队的时间
+    void as_server(int port, int workerCount = 0);
+
+    // 配置异步请求执行器（需在 run() 之前调用）：线程数与最大排队数，排队满时异步请求返回 "Server busy"
+    void setAsyncExecutor(size_t threadCount, size_t maxQueued);
+
+    ThreadPool::Stats executorStats() const { return m_executor->stats(); }
+
+    // 在 port 上绑定 PUB 套接字。携带 "client" 字段且 "notify" 为 true 的异步请求完成后，
+    // 结果以 [client, response] 两帧推送。PUB/SUB 在订阅尚未生效或超过高水位时会静默丢弃消息，
+    // 因此结果同时留在 getAsyncResult 轮询表中，直到客户端在后续请求的 "ack" 中确认或超过 TTL
+    void enableAsyncNotify(int port);
+
+    // 配置异步结果表（需在 run() 之前调用）：未被取走的结果超过 ttl 时被清除，所有客户端合计超过 maxSize 时淘汰最早的结果
+    void setAsyncResultLimits(std::chrono::milliseconds ttl, size_t maxSize);
+
+    AsyncResultStore::Stats asyncResultStats() const { return m_asyncResults->stats(); }
+
+    // 准入控制：同时执行的请求（同步、异步与协程方法均计入，直到结果产生）超过 maxInFlight，
+    // 或多线程模式下等待工作线程的请求超过 maxQueueDepth 时，新请求立即以 -32002 拒绝而不是排队；0 表示不限制。
+    // 可在 run() 之后随时调整，对之后到达的请求生效
+    void setAdmissionLimits(size_t maxInFlight, size_t maxQueueDepth) {
+        m_maxInFlight.store(maxInFlight, std::memory_order_relaxed);
+        m_maxQueueDepth.store(maxQueueDepth, std::memory_order_relaxed);
+    }
+
+    // 单个方法同时执行的上限，超出时以 -32002 拒绝；0 表示不限制。方法需已注册，覆盖注册后上限保留
+    void setMethodConcurrency(const std::string &method, size_t limit);
+
+    // ZMQ 套接字的收发高水位（需在 as_server 之前调用），默认使用 ZMQ 的 1000 条
+    void setHighWaterMark(int hwm) { m_hwm = hwm; }
+
+    // 各方法的调用数、执行中请求数、按错误码的错误数与延迟分位（微秒），以及请求解析、响应序列化的耗时
+    // 和无法归到某个方法的错误；method 非空时只返回该方法。客户端可通过内置方法 "getMetrics" 获取同样的内容。
+    // 调用数与错误数是精确的，耗时按 setLatencySampling 采样
+    Json::Value metrics(const std::string &method = "") const;
+
+    // 每个线程每 period 次请求（或方法执行）计时一次，默认 8；1 表示每次都计时。进程内所有服务器共享
+    static void setLatencySampling(uint32_t period) { LatencySampler::setPeriod(period); }
+
+    // 每隔 interval 以 INFO 级别把 metrics() 写入日志
+    void enableMetricsDump(std::chrono::milliseconds interval);
+
+    // 批量请求条目数不小于 threshold 时分发到异步执行器并行处理，按原顺序收集响应；0 表示始终串行
+    void setBatchParallelism(size_t threshold) { m_batchParallelThreshold = threshold; }
+
+    // 响应输出格式，默认紧凑格式（需在 run() 之前调用）
+    void setOutputStyle(JsonRpcProtocol::OutputStyle style) { m_outputStyle = style; }
+
+    // 协程方法运行所在的事件循环，首次调用或首次注册返回 Task 的方法时创建
+    EventLoop &eventLoop();
+
+    // 处理一条原始请求（单个或批量）并返回序列化后的响应；协程方法在此阻塞等待其结束
+    std::string process(const char *data, size_t size) {
+        return *process(data, size, nullptr, std::chrono::steady_clock::now());
+    }
+
+    // 协程方法的响应回调，在事件循环线程上调用
+    using Replier = std::function<void(std::string response)>;
+
+    // detach 非空时，单个同步请求若命中协程方法则不阻塞当前线程：调用 detach() 取得回调后返回 std::nullopt，
+    // 协程结束时把响应交给该回调。received 为收到请求的时间，请求中的 "timeout"（毫秒）从此时起算
+    std::optional<std::string> process(const char *data, size_t size, const std::function<Replier()> &detach,
+                                       std::chrono::steady_clock::time_point received);
+
+    std::string process(const std::string &requestStr) { return process(requestStr.data(), requestStr.size()); }
 
 private:
+    using CoroutineMethod = std::function<Task<Json::Value>(const Json::Value &params)>;
+
     struct RpcMethodInfo {
         RpcMethod method;
-        std::string requiredPermission;
+        std::string requiredPermission{};
+        std::shared_ptr<const CoroutineMethod> coroutine = nullptr;     // 返回 Task 的方法非空，method 为其阻塞版本
+        size_t maxConcurrency = 0;
+        std::shared_ptr<MethodMetrics> metrics = nullptr;   // 由 addMethod 创建，各代方法表共享
     };
 
+    using MethodTable = DispatchTable<RpcMethodInfo>;
+
+    // 占用的全局与方法级并发名额，析构时归还；为空表示被拒绝
+    class Permit {
+    public:
+        Permit() = default;
+
+        Permit(std::atomic<size_t> *global, std::atomic<size_t> *method) : m_global(global), m_method(method) {}
+
+        Permit(Permit &&other) noexcept
+                : m_global(std::exchange(other.m_global, nullptr)), m_method(std::exchange(other.m_method, nullptr)) {}
+
+        Permit &operator=(Permit &&other) noexcept {
+            std::swap(m_global, other.m_global);
+            std::swap(m_method, other.m_method);
+            return *this;
+        }
+
+        ~Permit() {
+            if (m_global) m_global->fetch_sub(1, std::memory_order_relaxed);
+            if (m_method) m_method->fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        explicit operator bool() const { return m_global != nullptr; }
+
+    private:
+        std::atomic<size_t> *m_global = nullptr;
+        std::atomic<size_t> *m_method = nullptr;
+    };
+
+    // 计数加一后超过 limit 则撤销并返回 false；limit 为 0 时只计数
+    static bool tryAcquire(std::atomic<size_t> &counter, size_t limit) {
+        size_t previous = counter.fetch_add(1, std::memory_order_relaxed);
+        if (limit != 0 && previous >= limit) {
+            counter.fetch_sub(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    Permit admit(const RpcMethodInfo &methodInfo) {
+        if (!tryAcquire(m_inFlight, m_maxInFlight.load(std::memory_order_relaxed))) return {};
+        if (!tryAcquire(methodInfo.metrics->inFlight, methodInfo.maxConcurrency)) {
+            m_inFlight.fetch_sub(1, std::memory_order_relaxed);
+            return {};
+        }
+        return {&m_inFlight, &methodInfo.metrics->inFlight};
+    }
+
+    // 执行方法并记录耗时，异常按类型计入对应错误码后原样抛出；params 为 Json::Value 或解析器视图
+    template<typename Params>
+    static Json::Value invokeMeasured(const RpcMethod &func, const Params &params, MethodMetrics &metrics);
+
+    // 权限检查与准入通过后执行 invoke，异常按类型转换为错误响应
+    template<typename Invoke>
+    Json::Value invokeChecked(const RpcMethodInfo &methodInfo, std::string_view userPermission, int id,
+                              Invoke &&invoke);
+
+    static Json::Value toJson(const LatencyHistogram &histogram);
+
+    static Json::Value toJson(const ErrorCounts &errors);
+
+    // 异步请求的受理应答；notify 为 true 表示结果将经推送端口送达，客户端据此决定是否继续等待
+    static Json::Value acceptedResponse(int id, bool notify) {
+        Json::Value response = JsonRpcProtocol::createResponse("Task accepted", id);
+        if (notify) response["notify"] = true;
+        return response;
+    }
+
+    static Json::Value busyResponse(const Json::Value &request) {
+        return JsonRpcProtocol::createErrorResponse(-32002, "Server busy", request["id"].asInt());
+    }
+
     // 异步处理请求
-    std::string handleRequestAsync(const Json::Value &request);
+    Json::Value handleRequestAsync(const Json::Value &request);
+
+    // 结果按 (client, id) 存放，client 为请求中的 "client" 字段
+    Json::Value getAsyncResult(const std::string &client, int requestId);
 
-    std::string getAsyncResult(int requestId);
+    // 推送模式的客户端在之后任意请求的 "ack" 数组中带上已收到推送的 id，对应的轮询备份随即删除
+    void acknowledge(const Json::Value &request);
 
-    bool checkPermission(const std::string &method, const std::string &userPermission) {
-        auto methodInfo = methods[method];
+    // 异步请求与 getAsyncResult 必须带非空的 "client"，否则不同客户端会共用空串这个键，互相读取或覆盖结果
+    static bool hasClient(const Json::Value &request) {
+        const Json::Value &client = request["client"];
+        return client.isString() && !stringView(client).empty();
+    }
+
+    static bool checkPermission(const RpcMethodInfo &methodInfo, std::string_view userPermission) {
         if (methodInfo.requiredPermission.empty()) return true;
         return userPermission == methodInfo.requiredPermission;
     }
 
-    // 处理请求
-    std::string handleRequest(const Json::Value &request);
+    // 无锁读取当前方法表，只做一次哈希查找；须在 EpochReclaimer::Guard 内调用，返回值在 Guard 析构前有效
+    const RpcMethodInfo *findMethod(std::string_view method) const {
+        return m_methods.load(std::memory_order_seq_cst)->find(method);
+    }
+
+    // 以新表替换当前表并原子发布，读者无需加锁
+    void addMethod(const std::string &method, RpcMethodInfo info, bool overwrite);
+
+    // 发布新表，旧表等读者全部离开后释放；调用方持有 m_registerMtx
+    void publishMethods(std::unique_ptr<MethodTable> table);
+
+    // call(params) 解码参数并返回用户协程的 Task
+    template<typename Call>
+    void addCoroutineMethod(const std::string &method, Call call, bool overwrite, const std::string &requiredPermission);
+
+    // 在事件循环上启动协程方法，结束后把响应交给 detach() 返回的回调；不是协程方法时返回 false
+    bool dispatchCoroutine(const Json::Value &request, JsonRpcProtocol::Encoding encoding,
+                           const std::function<Replier()> &detach, std::chrono::steady_clock::time_point received);
+
+    // 与同步路径相同的错误码映射：std::invalid_argument 为 -32602，zmq::error_t 为 -32000，其余为 -32603
+    static Json::Value completionResponse(std::exception_ptr error, const std::optional<Json::Value> &result, int id);
+
+    static int errorCode(std::exception_ptr error);
+
+    static void fulfil(std::promise<Json::Value> &promise, std::exception_ptr error, std::optional<Json::Value> result) {
+        if (error) {
+            promise.set_exception(error);
+        } else {
+            promise.set_value(std::move(*result));
+        }
+    }
+
+    // 字符串成员的只读视图，非字符串时为空
+    static std::string_view stringView(const Json::Value &value) {
+        const char *begin = nullptr;
+        const char *end = nullptr;
+        if (!value.getString(&begin, &end)) return {};
+        return {begin, static_cast<size_t>(end - begin)};
+    }
+
+    // 处理请求，内部各环节只传递 Json::Value，仅在 process 出口序列化一次
+    Json::Value handleRequest(const Json::Value &request);
 
-    std::string handleBatchRequest(const Json::Value &batchRequest);
+    Json::Value handleBatchRequest(const Json::Value &batchRequest, std::chrono::steady_clock::time_point received);
+
+    // 按 async 字段分派单个请求，异常转换为错误响应，可在任意线程调用；已超过期限的请求直接返回 -32003
+    Json::Value dispatch(const Json::Value &request, std::chrono::steady_clock::time_point received);
+
+    // 请求中 "timeout" 的上限，客户端给出更大的值（包括超出 Int64 的数）时按此截断，received + timeout 不会溢出
+    static constexpr std::chrono::milliseconds kMaxTimeout = std::chrono::hours(24);
+
+    // 请求带 "timeout" 且自 received 起已超时，执行它的结果客户端已不再等待；负数按 0 处理
+    static bool pastDeadline(const Json::Value &request, std::chrono::steady_clock::time_point received) {
+        const Json::Value &timeout = request["timeout"];
+        return timeout.isNumeric() && pastDeadline(timeout.asDouble(), received);
+    }
+
+    static bool pastDeadline(double timeoutMillis, std::chrono::steady_clock::time_point received) {
+        double millis = std::clamp(timeoutMillis, 0.0, static_cast<double>(kMaxTimeout.count()));
+        return std::chrono::steady_clock::now() >
+               received + std::chrono::milliseconds(static_cast<std::chrono::milliseconds::rep>(millis));
+    }
 
-    std::string process(const std::string &requestStr);
+#ifdef JSONRPC_USE_SIMDJSON
+    // 单个同步 JSON 请求的快速路径：simdjson on-demand 扫描请求对象，参数直接从解析器视图解码，不构建 Json::Value。
+    // 请求带有异步、确认等字段，方法是内置方法或没有视图调用器，或在调用前解析出错时返回空，由通用路径重新处理
+    std::optional<std::string> processView(const char *data, size_t size,
+                                           std::chrono::steady_clock::time_point received, bool sampled);
+#endif
+
+    bool send(zmq::socket_t &socket, zmq::message_t &data);
+
+    bool recv(zmq::socket_t &socket, zmq::message_t &data);
+
+    // 在给定套接字上循环 recv->process->send，直到上下文关闭。routed 为 true 时套接字为 DEALER，
+    // 请求前带有路由帧，协程方法的回复可以晚于后续请求发出
+    void serve(zmq::socket_t &socket, bool routed);
+
+    // 发送 [路由帧..., response]
+    static void sendReply(zmq::socket_t &socket, std::vector<zmq::message_t> &envelope, std::string response);
+
+    // 前端转给工作线程的消息固定以时间帧开头：[u8 kStampVersion][i64 前端收到请求时的 steady_clock 计数]
+    static constexpr uint8_t kStampVersion = 1;
+    static constexpr size_t kStampSize = 1 + sizeof(int64_t);
+
+    // 把一条完整的多帧消息从 from 转发到 to；stamp 为 true 时在前面加一帧时间帧，并计入 m_queued
+    void forward(zmq::socket_t &from, zmq::socket_t &to, bool stamp = false);
+
+    // 工作线程队列已满：读出前端的一条完整消息，不转发给后端，直接回复 -32002
+    void shed(zmq::socket_t &front);
+
+    void applyHighWaterMark(zmq::socket_t &socket) const;
 
 private:
-    std::unordered_map<std::string, RpcMethodInfo> methods;
-    std::unordered_map<int, std::future<Json::Value>> async_result;
-    std::mutex async_mutex;
+    // 当前方法表，由 m_methodTable 持有；被替换的旧表交给 m_retiredTables，没有读者后释放
+    std::unique_ptr<MethodTable> m_methodTable = std::make_unique<MethodTable>();
+    std::atomic<const MethodTable *> m_methods;
+    EpochReclaimer m_retiredTables;
+    std::mutex m_registerMtx;
+    std::unique_ptr<AsyncResultStore> m_asyncResults;
+    std::unique_ptr<ThreadPool> m_executor;
+    std::unique_ptr<EventLoop> m_loop;
     zmq::context_t m_context;
     std::unique_ptr<zmq::socket_t> m_socket;
-    BlockQueue<std::string> requests;
-    BlockQueue<std::string> responses;
+    std::unique_ptr<zmq::socket_t> m_backend;
+    std::string m_backendAddr;
+    // 事件循环线程经 m_replyPush 发出协程方法的回复，由 run() 转发给前端
+    std::unique_ptr<zmq::socket_t> m_replyPull;
+    std::unique_ptr<zmq::socket_t> m_replyPush;
+    std::mutex m_replyMtx;
+    int m_workerCount = 0;
+    size_t m_batchParallelThreshold = 0;
+    JsonRpcProtocol::OutputStyle m_outputStyle = JsonRpcProtocol::OutputStyle::Compact;
+    std::atomic<bool> m_stopped{false};
+    std::atomic<size_t> m_inFlight{0};
+    std::atomic<size_t> m_queued{0};        // 已转发给后端、尚未被工作线程取走的请求
+    std::atomic<size_t> m_maxInFlight{0};
+    std::atomic<size_t> m_maxQueueDepth{0};
+    int m_hwm = -1;
+    LatencyHistogram m_parseLatency;
+    LatencyHistogram m_serializeLatency;
+    ErrorCounts m_requestErrors;            // 解析失败、方法不存在、超期等无法归到某个方法的错误
+    std::mutex m_dumpMtx;
+    std::condition_variable m_dumpCond;
+    bool m_dumpStop = false;
+    std::thread m_metricsDumper;
+    std::vector<std::thread> m_workers;
+    // 待推送的异步结果 (client, response)，由 m_notifier 线程独占 m_pubSocket 发送；满时完成任务的线程等待
+    MpmcQueue<std::pair<std::string, std::string>> m_notifications{1024};
+    std::unique_ptr<zmq::socket_t> m_pubSocket;
+    std::thread m_notifier;
 
 };
 
 
-std::string JsonRpcServer::handleRequestAsync(const Json::Value &request) {
-    std::string method = request["method"].asString();
-    std::string userPermission= request["userPermission"].asString();
-    if (methods.find(method) == methods.end()) {
+inline Json::Value JsonRpcServer::handleRequestAsync(const Json::Value &request) {
+    if (!hasClient(request)) {
+        m_requestErrors.add(-32600);
+        return JsonRpcProtocol::createErrorResponse(-32600, "Invalid Request: async call requires \"client\"",
+                                                    request["id"].asInt());
+    }
+    EpochReclaimer::Guard guard;
+    const RpcMethodInfo *methodInfo = findMethod(stringView(request["method"]));
+    if (methodInfo == nullptr) {
+        m_requestErrors.add(-32601);
         return JsonRpcProtocol::createErrorResponse(-32601, "Method not found",
-                                                    request["id"].asInt()).toStyledString();
+                                                    request["id"].asInt());
     }
-    if (!checkPermission(method, userPermission)) {
-        return JsonRpcProtocol::createErrorResponse(-32001, "Permission denied", request["id"].asInt()).toStyledString();
+    const std::shared_ptr<MethodMetrics> &metrics = methodInfo->metrics;
+    if (!checkPermission(*methodInfo, stringView(request["userPermission"]))) {
+        metrics->reject(-32001);
+        return JsonRpcProtocol::createErrorResponse(-32001, "Permission denied", request["id"].asInt());
     }
+    // 名额随任务一起移交，结果产生后归还
+    Permit permit = admit(*methodInfo);
+    if (!permit) {
+        metrics->reject(-32002);
+        return busyResponse(request);
+    }
+    auto held = std::make_shared<Permit>(std::move(permit));
     try {
-        // 异步调用方法并返回 future
-        auto futureResult = std::async(std::launch::async, methods[method].method, request["params"]);
-        {
-            std::lock_guard<std::mutex> lock(async_mutex);
-            async_result[request["id"].asInt()] = std::move(futureResult);
+        if (methodInfo->coroutine) {
+            // 协程方法直接在事件循环上运行，不占用执行器线程；延迟从启动到结束，包含挂起的时间
+            int id = request["id"].asInt();
+            // 协程挂起期间方法表可能被替换释放，完成回调持有 coroutine 使其中的可调用对象保持存活
+            const auto &coroutine = methodInfo->coroutine;
+            Task<Json::Value> task = (*coroutine)(request["params"]);
+            auto start = std::chrono::steady_clock::now();
+            bool notify = m_pubSocket && request["notify"].asBool();
+            auto promise = std::make_shared<std::promise<Json::Value>>();
+            m_asyncResults->put(request["client"].asString(), id, promise->get_future());
+            m_loop->spawn(std::move(task), [this, id, client = request["client"].asString(), notify, promise, held,
+                    metrics, coroutine, start](std::exception_ptr error, std::optional<Json::Value> result) {
+                metrics->record(std::chrono::steady_clock::now() - start, errorCode(error));
+                if (notify) {
+                    Json::Value response = completionResponse(error, result, id);
+                    m_notifications.push({client, JsonRpcProtocol::serialize(response, m_outputStyle)});
+                }
+                fulfil(*promise, error, std::move(result));
+            });
+            return acceptedResponse(id, notify);
+        }
+        if (m_pubSocket && request["notify"].asBool()) {
+            // 推送模式：任务完成后把完整响应交给推送线程，结果同时留在结果表中，推送丢失时客户端仍可轮询取回
+            int id = request["id"].asInt();
+            std::string client = request["client"].asString();
+            auto promise = std::make_shared<std::promise<Json::Value>>();
+            m_asyncResults->put(client, id, promise->get_future());
+            auto accepted = m_executor->trySubmit(
+                    [this, func = methodInfo->method, params = request["params"], id, client, promise, held, metrics] {
+                        std::exception_ptr error;
+                        std::optional<Json::Value> result;
+                        try {
+                            result = invokeMeasured(func, params, *metrics);
+                        } catch (...) {
+                            error = std::current_exception();
+                        }
+                        *held = Permit();
+                        Json::Value response = completionResponse(error, result, id);
+                        m_notifications.push({client, JsonRpcProtocol::serialize(response, m_outputStyle)});
+                        fulfil(*promise, error, std::move(result));
+                    });
+            if (!accepted) {
+                m_asyncResults->discard(client, id);
+                metrics->reject(-32002);
+                return busyResponse(request);
+            }
+            return acceptedResponse(id, true);
         }
+        // 提交到有界线程池，队列满时拒绝而不是无限创建线程
+        auto futureResult = m_executor->trySubmit(
+                [func = methodInfo->method, params = request["params"], held, metrics] {
+                    // 任务对象存放在 future 的共享状态里，要到结果被取走才析构，名额在执行结束时就归还
+                    Permit permit = std::move(*held);
+                    return invokeMeasured(func, params, *metrics);
+                });
+        if (!futureResult) {
+            metrics->reject(-32002);
+            return busyResponse(request);
+        }
+        m_asyncResults->put(request["client"].asString(), request["id"].asInt(), std::move(*futureResult));
 
-        return JsonRpcProtocol::createResponse("Task accepted", request["id"].asInt()).toStyledString();
+        return acceptedResponse(request["id"].asInt(), false);
+    } catch (const std::invalid_argument &e) {
+        metrics->reject(-32602);
+        return JsonRpcProtocol::createErrorResponse(-32602, "Invalid parameters: " + std::string(e.what()),
+                                                    request["id"].asInt());
     } catch (const std::exception &e) {
+        metrics->reject(-32603);
         return JsonRpcProtocol::createErrorResponse(-32603, "Async internal error: " + std::string(e.what()),
-                                                    request["id"].asInt()).toStyledString();
+                                                    request["id"].asInt());
     }
 }
 
-std::string JsonRpcServer::handleRequest(const Json::Value &request) {
-
-
-    std::string method = request["method"].asString();
-    std::string userPermission= request["userPermission"].asString();
+inline Json::Value JsonRpcServer::handleRequest(const Json::Value &request) {
+    std::string_view method = stringView(request["method"]);
     if (method == "getAsyncResult") {
-        return getAsyncResult(request["params"].asInt());
+        // 兼容 "params": [id] 与 "params": id 两种写法
+        const Json::Value &params = request["params"];
+        int requestId = params.isArray() ? params[0].asInt() : params.asInt();
+        if (!hasClient(request)) {
+            m_requestErrors.add(-32600);
+            return JsonRpcProtocol::createErrorResponse(-32600, "Invalid Request: getAsyncResult requires \"client\"",
+                                                        request["id"].asInt());
+        }
+        return getAsyncResult(request["client"].asString(), requestId);
+    }
+    if (method == "getMetrics") {
+        // "params": ["add"] 或 "add" 只返回该方法，省略时返回全部
+        const Json::Value &params = request["params"];
+        const Json::Value &name = params.isArray() ? params[0] : params;
+        return JsonRpcProtocol::createResponse(metrics(name.isString() ? name.asString() : ""),
+                                               request["id"].asInt());
     }
-    if (methods.find(method) == methods.end()) {
+    EpochReclaimer::Guard guard;
+    const RpcMethodInfo *methodInfo = findMethod(method);
+    if (methodInfo == nullptr) {
+        m_requestErrors.add(-32601);
         return JsonRpcProtocol::createErrorResponse(-32601, "Method not found",
-                                                    request["id"].asInt()).toStyledString();
+                                                    request["id"].asInt());
     }
 
-    if (!checkPermission(method, userPermission)) {
-        return JsonRpcProtocol::createErrorResponse(-32001, "Permission denied", request["id"].asInt()).toStyledString();
+    return invokeChecked(*methodInfo, stringView(request["userPermission"]), request["id"].asInt(), [&] {
+        return invokeMeasured(methodInfo->method, request["params"], *methodInfo->metrics);
+    });
+}
+
+template<typename Invoke>
+Json::Value JsonRpcServer::invokeChecked(const RpcMethodInfo &methodInfo, std::string_view userPermission, int id,
+                                         Invoke &&invoke) {
+    if (!checkPermission(methodInfo, userPermission)) {
+        methodInfo.metrics->reject(-32001);
+        return JsonRpcProtocol::createErrorResponse(-32001, "Permission denied", id);
+    }
+    Permit permit = admit(methodInfo);
+    if (!permit) {
+        methodInfo.metrics->reject(-32002);
+        return JsonRpcProtocol::createErrorResponse(-32002, "Server busy", id);
     }
     try {
-        Json::Value result = methods[method].method(request["params"]);
+        Json::Value result = invoke();
 
-        auto response = JsonRpcProtocol::createResponse(result, request["id"].asInt()).toStyledString();
-        return response;
+        return JsonRpcProtocol::createResponse(result, id);
     } catch (const std::invalid_argument &e) {
-        return JsonRpcProtocol::createErrorResponse(-32602, "Invalid parameters: " + std::string(e.what()),
-                                                    request["id"].asInt()).toStyledString();
+        return JsonRpcProtocol::createErrorResponse(-32602, "Invalid parameters: " + std::string(e.what()), id);
     } catch (const zmq::error_t &e) {
-        return JsonRpcProtocol::createErrorResponse(-32000, "ZeroMQ error: " + std::string(e.what()),
-                                                    request["id"].asInt()).toStyledString();
+        return JsonRpcProtocol::createErrorResponse(-32000, "ZeroMQ error: " + std::string(e.what()), id);
     } catch (const std::exception &e) {
-        return JsonRpcProtocol::createErrorResponse(-32603, "Internal error: " + std::string(e.what()),
-                                                    request["id"].asInt()).toStyledString();
+        return JsonRpcProtocol::createErrorResponse(-32603, "Internal error: " + std::string(e.what()), id);
+    }
+}
+
+inline Json::Value JsonRpcServer::getAsyncResult(const std::string &client, int requestId) {
+    std::future<Json::Value> future;
+    switch (m_asyncResults->take(client, requestId, future)) {
+        case AsyncResultStore::Status::NotFound:
+            return JsonRpcProtocol::createErrorResponse(-32602, "Task not found", requestId);
+        case AsyncResultStore::Status::Pending:
+            return JsonRpcProtocol::createResponse("Task still processing", requestId);
+        case AsyncResultStore::Status::Ready:
+            break;
+    }
+    try {
+        return JsonRpcProtocol::createResponse(future.get(), requestId);
+    } catch (...) {
+        return completionResponse(std::current_exception(), std::nullopt, requestId);
     }
 }
 
-std::string JsonRpcServer::getAsyncResult(int requestId) {
-    std::lock_guard<std::mutex> lock(async_mutex);
-    if (async_result.find(requestId) == async_result.end()) {
-        return JsonRpcProtocol::createErrorResponse(-32602, "Task not found", requestId).toStyledString();
+inline void JsonRpcServer::acknowledge(const Json::Value &request) {
+    const Json::Value &ack = request["ack"];
+    if (!hasClient(request) || !ack.isArray()) return;
+    std::string client = request["client"].asString();
+    for (const auto &id: ack) {
+        if (id.isInt()) m_asyncResults->discard(client, id.asInt());
     }
+}
 
-    auto &future = async_result[requestId];
-    if (future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
-        Json::Value result = future.get();
-        async_result.erase(requestId);
-        return JsonRpcProtocol::createResponse(result, requestId).toStyledString();
-    } else {
-        return JsonRpcProtocol::createResponse("Task still processing", requestId).toStyledString();
+inline void JsonRpcServer::setAsyncResultLimits(std::chrono::milliseconds ttl, size_t maxSize) {
+    m_asyncResults = std::make_unique<AsyncResultStore>(ttl, maxSize);
+}
+
+inline void JsonRpcServer::setAsyncExecutor(size_t threadCount, size_t maxQueued) {
+    // 旧线程池析构时会执行完已排队的任务，已返回的 future 仍然有效
+    m_executor = std::make_unique<ThreadPool>(threadCount, maxQueued);
+}
+
+inline void JsonRpcServer::enableAsyncNotify(int port) {
+    std::ostringstream os;
+    os << "tcp://*:" << port;
+    m_pubSocket = std::make_unique<zmq::socket_t>(m_context, ZMQ_PUB);
+    m_pubSocket->bind(os.str());
+    m_notifier = std::thread([this] {
+        std::pair<std::string, std::string> notification;
+        bool terminated = false;
+        while (m_notifications.pop(notification)) {
+            // 上下文关闭后仍要继续取出并丢弃，否则推送方会阻塞在已满的队列上
+            if (terminated) continue;
+            try {
+                m_pubSocket->send(zmq::buffer(notification.first), zmq::send_flags::sndmore);
+                m_pubSocket->send(takeMessage(std::move(notification.second)), zmq::send_flags::none);
+            } catch (const zmq::error_t &e) {
+                if (e.num() == ETERM) {
+                    terminated = true;
+                    continue;
+                }
+                LOG_ERROR("ZMQ publish error: {}", e.what());
+            }
+        }
+    });
+}
+
+template<typename Params>
+Json::Value JsonRpcServer::invokeMeasured(const RpcMethod &func, const Params &params, MethodMetrics &metrics) {
+    // 未采样的调用不取时间，只计数
+    bool sampled = LatencySampler::sample(LatencySampler::Method);
+    auto start = sampled ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+    auto finish = [&](int code) {
+        if (sampled) {
+            metrics.record(std::chrono::steady_clock::now() - start, code);
+        } else {
+            metrics.count(code);
+        }
+    };
+    try {
+        Json::Value result = func(params);
+        finish(0);
+        return result;
+    } catch (const std::invalid_argument &) {
+        finish(-32602);
+        throw;
+    } catch (const zmq::error_t &) {
+        finish(-32000);
+        throw;
+    } catch (...) {
+        finish(-32603);
+        throw;
+    }
+}
+
+inline Json::Value JsonRpcServer::toJson(const LatencyHistogram &histogram) {
+    LatencyHistogram::Summary summary = histogram.summary();
+    Json::Value value(Json::objectValue);
+    value["count"] = static_cast<Json::UInt64>(summary.count);
+    value["meanUs"] = summary.meanMicros;
+    value["p50Us"] = summary.p50Micros;
+    value["p90Us"] = summary.p90Micros;
+    value["p99Us"] = summary.p99Micros;
+    value["p999Us"] = summary.p999Micros;
+    value["maxUs"] = summary.maxMicros;
+    return value;
+}
+
+inline Json::Value JsonRpcServer::toJson(const ErrorCounts &errors) {
+    Json::Value value(Json::objectValue);
+    errors.forEach([&value](int code, uint64_t count) {
+        value[code == 0 ? std::string("other") : std::to_string(code)] = static_cast<Json::UInt64>(count);
+    });
+    return value;
+}
+
+inline Json::Value JsonRpcServer::metrics(const std::string &method) const {
+    Json::Value result(Json::objectValue);
+    Json::Value &methods = result["methods"] = Json::Value(Json::objectValue);
+    EpochReclaimer::Guard guard;
+    m_methods.load(std::memory_order_seq_cst)->forEach([&](const std::string &name, const RpcMethodInfo &info) {
+        if (!method.empty() && name != method) return;
+        Json::Value &entry = methods[name];
+        Json::Value latency = toJson(info.metrics->latency);
+        entry["calls"] = static_cast<Json::UInt64>(info.metrics->executed.load(std::memory_order_relaxed) +
+                                                   info.metrics->rejected.load(std::memory_order_relaxed));
+        entry["inFlight"] = static_cast<Json::UInt64>(info.metrics->inFlight.load(std::memory_order_relaxed));
+        entry["errors"] = toJson(info.metrics->errors);
+        entry["latency"] = std::move(latency);
+    });
+    if (method.empty()) {
+        result["parse"] = toJson(m_parseLatency);
+        result["serialize"] = toJson(m_serializeLatency);
+        result["errors"] = toJson(m_requestErrors);
+        result["inFlight"] = static_cast<Json::UInt64>(m_inFlight.load(std::memory_order_relaxed));
+    }
+    return result;
+}
+
+inline void JsonRpcServer::enableMetricsDump(std::chrono::milliseconds interval) {
+    m_metricsDumper = std::thread([this, interval] {
+        std::unique_lock<std::mutex> lock(m_dumpMtx);
+        while (!m_dumpCond.wait_for(lock, interval, [this] { return m_dumpStop; })) {
+            std::string snapshot = JsonRpcProtocol::serialize(metrics(), JsonRpcProtocol::OutputStyle::Compact);
+            LOG_INFO("metrics {}", snapshot)
+        }
+    });
+}
+
+inline JsonRpcServer::~JsonRpcServer() {
+    if (m_metricsDumper.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_dumpMtx);
+            m_dumpStop = true;
+        }
+        m_dumpCond.notify_one();
+        m_metricsDumper.join();
+    }
+    // 先关闭上下文使阻塞在 recv 上的工作线程以 ETERM 退出，之后不再有新请求提交到线程池或事件循环
+    m_stopped = true;
+    m_context.shutdown();
+    for (auto &worker: m_workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
     }
+    // 再排空异步任务，它们可能仍在向 m_notifications 推送结果
+    m_executor.reset();
+    // 事件循环上的协程同样可能推送结果或发出回复
+    m_loop.reset();
+    // 推送线程取完剩余的结果后退出；上下文已关闭，这些结果不再发出
+    m_notifications.close();
+    if (m_notifier.joinable()) {
+        m_notifier.join();
+    }
+}
+
+inline bool JsonRpcServer::send(zmq::message_t &data) {
+    return send(*m_socket, data);
 }
 
-bool JsonRpcServer::send(zmq::message_t &data) {
+inline bool JsonRpcServer::recv(zmq::message_t &data) {
+    return recv(*m_socket, data);
+}
+
+inline bool JsonRpcServer::send(zmq::socket_t &socket, zmq::message_t &data) {
     try {
-        m_socket->send(data, zmq::send_flags::none);
+        socket.send(data, zmq::send_flags::none);
         return true;
     } catch (const zmq::error_t &e) {
-        LOG_ERROR(std::format("ZMQ send error: {}", e.what()).c_str());
+        LOG_ERROR("ZMQ send error: {}", e.what());
         return false;
     }
 }
 
-bool JsonRpcServer::recv(zmq::message_t &data) {
+inline bool JsonRpcServer::recv(zmq::socket_t &socket, zmq::message_t &data) {
     try {
-        m_socket->recv(data);
-        return true;
+        return socket.recv(data).has_value();
     } catch (const zmq::error_t &e) {
-        LOG_ERROR(std::format("ZMQ recv error: {}", e.what()).c_str());
+        if (e.num() != ETERM) {
+            LOG_ERROR("ZMQ recv error: {}", e.what());
+        }
         return false;
     }
 }
 
-void JsonRpcServer::as_server(int port) {
-    m_socket = std::make_unique<zmq::socket_t>(m_context, ZMQ_REP);
+inline void JsonRpcServer::as_server(int port, int workerCount) {
     std::ostringstream os;
     os << "tcp://*:" << port;
+    m_workerCount = workerCount;
+    if (workerCount <= 0) {
+        m_socket = std::make_unique<zmq::socket_t>(m_context, ZMQ_REP);
+        applyHighWaterMark(*m_socket);
+        m_socket->bind(os.str());
+        return;
+    }
+    // ROUTER 在回复时按身份帧路由回对应客户端，工作线程使用 REP 套接字，信封由 ZMQ 自动处理
+    m_socket = std::make_unique<zmq::socket_t>(m_context, ZMQ_ROUTER);
+    applyHighWaterMark(*m_socket);
     m_socket->bind(os.str());
+    m_backendAddr = std::format("inproc://jsonrpc-workers-{}", static_cast<const void *>(this));
+    m_backend = std::make_unique<zmq::socket_t>(m_context, ZMQ_DEALER);
+    applyHighWaterMark(*m_backend);
+    m_backend->bind(m_backendAddr);
+    std::string replyAddr = std::format("inproc://jsonrpc-replies-{}", static_cast<const void *>(this));
+    m_replyPull = std::make_unique<zmq::socket_t>(m_context, ZMQ_PULL);
+    m_replyPull->bind(replyAddr);
+    m_replyPush = std::make_unique<zmq::socket_t>(m_context, ZMQ_PUSH);
+    m_replyPush->connect(replyAddr);
+}
+
+inline void JsonRpcServer::applyHighWaterMark(zmq::socket_t &socket) const {
+    if (m_hwm < 0) return;
+    socket.set(zmq::sockopt::sndhwm, m_hwm);
+    socket.set(zmq::sockopt::rcvhwm, m_hwm);
 }
 
-void JsonRpcServer::run() {
+inline void JsonRpcServer::serve(zmq::socket_t &socket, bool routed) {
+    std::vector<zmq::message_t> envelope;
     while (true) {
         zmq::message_t data;
-        recv(data);
-        std::string request((char *) data.data(), data.size());
-        std::string response = process(request);
-        zmq::message_t retmsg(response.length());
-        memcpy(retmsg.data(), response.data(), response.size());
-        send(retmsg);
+        if (!recv(socket, data)) {
+            if (m_stopped) break;
+            continue;
+        }
+        if (!routed) {
+            // 单 REP 套接字看不到请求在 ZMQ 接收缓冲里等待的时间，期限只能从读出请求时算起
+            auto received = std::chrono::steady_clock::now();
+            // 直接在接收到的帧上解析，响应缓冲区的所有权交给 ZMQ
+            zmq::message_t retmsg = takeMessage(*process(data.data<char>(), data.size(), nullptr, received));
+            send(socket, retmsg);
+            continue;
+        }
+        // 首帧固定是前端加上的时间帧，按位置而不是长度识别，任意长度的路由帧都不会被误认；
+        // 排队等待工作线程的时间同样计入请求期限
+        if (data.size() != kStampSize || data.data<uint8_t>()[0] != kStampVersion || !data.more()) {
+            LOG_ERROR("malformed stamp frame ({} bytes), message dropped", data.size());
+            while (data.more()) {
+                data = zmq::message_t();
+                if (!recv(socket, data)) break;
+            }
+            if (m_stopped) break;
+            continue;
+        }
+        m_queued.fetch_sub(1, std::memory_order_relaxed);
+        int64_t ticks;
+        std::memcpy(&ticks, data.data<char>() + 1, sizeof ticks);
+        auto received = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(ticks));
+        data = zmq::message_t();
+        if (!recv(socket, data)) {
+            if (m_stopped) break;
+            continue;
+        }
+        // 最后一帧是请求，之前的路由帧在回复时原样带回
+        envelope.clear();
+        bool complete = true;
+        while (data.more()) {
+            envelope.push_back(std::move(data));
+            data = zmq::message_t();
+            if (!recv(socket, data)) {
+                complete = false;
+                break;
+            }
+        }
+        if (!complete) {
+            if (m_stopped) break;
+            continue;
+        }
+        auto detach = [this, &envelope]() -> Replier {
+            auto frames = std::make_shared<std::vector<zmq::message_t>>(std::move(envelope));
+            return [this, frames](std::string response) {
+                std::lock_guard<std::mutex> lock(m_replyMtx);
+                sendReply(*m_replyPush, *frames, std::move(response));
+            };
+        };
+        std::optional<std::string> response = process(data.data<char>(), data.size(), detach, received);
+        if (response) {
+            sendReply(socket, envelope, std::move(*response));
+        }
     }
 }
 
-std::string JsonRpcServer::process(const std::string &requestStr) {
-    LOG_DEBUG(requestStr.c_str())
-    Json::CharReaderBuilder readerBuilder;
+inline void JsonRpcServer::sendReply(zmq::socket_t &socket, std::vector<zmq::message_t> &envelope, std::string response) {
+    try {
+        for (auto &frame: envelope) {
+            socket.send(frame, zmq::send_flags::sndmore);
+        }
+        socket.send(takeMessage(std::move(response)), zmq::send_flags::none);
+    } catch (const zmq::error_t &e) {
+        if (e.num() != ETERM) {
+            LOG_ERROR("ZMQ send error: {}", e.what());
+        }
+    }
+}
+
+inline void JsonRpcServer::forward(zmq::socket_t &from, zmq::socket_t &to, bool stamp) {
+    bool more = true;
+    while (more) {
+        zmq::message_t frame;
+        if (!from.recv(frame, zmq::recv_flags::dontwait)) return;
+        if (stamp) {
+            // 确实取到消息才计数，且先于发送，工作线程的减一不会早于这里的加一
+            m_queued.fetch_add(1, std::memory_order_relaxed);
+            int64_t ticks = std::chrono::steady_clock::now().time_since_epoch().count();
+            char header[kStampSize] = {static_cast<char>(kStampVersion)};
+            std::memcpy(header + 1, &ticks, sizeof ticks);
+            to.send(zmq::message_t(header, sizeof header), zmq::send_flags::sndmore);
+            stamp = false;
+        }
+        more = frame.more();
+        to.send(frame, more ? zmq::send_flags::sndmore : zmq::send_flags::none);
+    }
+}
+
+inline void JsonRpcServer::shed(zmq::socket_t &front) {
+    std::vector<zmq::message_t> envelope;
+    zmq::message_t data;
+    if (!front.recv(data, zmq::recv_flags::dontwait)) return;
+    while (data.more()) {
+        envelope.push_back(std::move(data));
+        data = zmq::message_t();
+        if (!front.recv(data, zmq::recv_flags::dontwait)) return;
+    }
+    // 只为取出 id 与编码而解析，拒绝的代价仍远小于排队后再执行
+    auto encoding = JsonRpcProtocol::detectEncoding(data.data<char>(), data.data<char>() + data.size());
     Json::Value request;
-    std::string errs;
-    std::string result;
-    std::istringstream ss(requestStr);
-    if (!Json::parseFromStream(readerBuilder, ss, &request, &errs)) {
-        result = JsonRpcProtocol::createErrorResponse(-32700, "Parse error", 0).toStyledString();
-        return result;
+    int id = 0;
+    if (JsonRpcProtocol::parse(data.data<char>(), data.data<char>() + data.size(), request) && request.isObject()) {
+        id = request["id"].asInt();
     }
-    if (request.isArray()) {
-        return handleBatchRequest(request);
+    m_requestErrors.add(-32002);
+    Json::Value response = JsonRpcProtocol::createErrorResponse(-32002, "Server busy", id);
+    sendReply(front, envelope, JsonRpcProtocol::serialize(response, m_outputStyle, encoding));
+}
+
+inline void JsonRpcServer::run() {
+    if (m_workerCount <= 0) {
+        serve(*m_socket, false);
+        return;
     }
-    if (!request.isMember("method") || !request["method"].isString()) {
-        result = JsonRpcProtocol::createErrorResponse(-32600, "Invalid Request",
-                                                      request["id"].asInt()).toStyledString();
-        return result;
+    for (int i = 0; i < m_workerCount; ++i) {
+        m_workers.emplace_back([this] {
+            zmq::socket_t socket(m_context, ZMQ_DEALER);
+            applyHighWaterMark(socket);
+            socket.connect(m_backendAddr);
+            serve(socket, true);
+        });
     }
+    LOG_INFO("router mode with {} workers", m_workerCount)
+    try {
+        // 相当于 zmq::proxy，另外把事件循环线程发出的协程方法回复转给前端
+        zmq::pollitem_t items[] = {
+                {static_cast<void *>(*m_socket), 0, ZMQ_POLLIN, 0},
+                {static_cast<void *>(*m_backend), 0, ZMQ_POLLIN, 0},
+                {static_cast<void *>(*m_replyPull), 0, ZMQ_POLLIN, 0},
+        };
+        while (true) {
+            zmq::poll(items, 3, std::chrono::milliseconds{-1});
+            if (items[0].revents & ZMQ_POLLIN) {
+                size_t maxQueueDepth = m_maxQueueDepth.load(std::memory_order_relaxed);
+                if (maxQueueDepth != 0 && m_queued.load(std::memory_order_relaxed) >= maxQueueDepth) {
+                    shed(*m_socket);
+                } else {
+                    forward(*m_socket, *m_backend, true);
+                }
+            }
+            if (items[1].revents & ZMQ_POLLIN) forward(*m_backend, *m_socket);
+            if (items[2].revents & ZMQ_POLLIN) forward(*m_replyPull, *m_socket);
+        }
+    } catch (const zmq::error_t &e) {
+        if (e.num() != ETERM) {
+            LOG_ERROR("ZMQ proxy error: {}", e.what());
+        }
+    }
+}
 
-    if (!request["async"].asBool()) {
-        result = handleRequest(request);
+inline std::optional<std::string> JsonRpcServer::process(const char *data, size_t size,
+                                                  const std::function<Replier()> &detach,
+                                                  std::chrono::steady_clock::time_point received) {
+    // 响应使用与请求相同的编码
+    auto encoding = JsonRpcProtocol::detectEncoding(data, data + size);
+    if (encoding == JsonRpcProtocol::Encoding::Json) {
+        LOG_DEBUG("{}", std::string_view(data, size))
+    } else {
+        LOG_DEBUG("msgpack request: {} bytes", size)
+    }
+    Json::Value request;
+    Json::Value response;
+    // 解析与序列化按同一次采样决定是否计时
+    bool sampled = LatencySampler::sample(LatencySampler::Request);
+#ifdef JSONRPC_USE_SIMDJSON
+    if (encoding == JsonRpcProtocol::Encoding::Json) {
+        if (std::optional<std::string> result = processView(data, size, received, sampled)) {
+            LOG_DEBUG("{}", *result);
+            return result;
+        }
+    }
+#endif
+    auto parseStart = sampled ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+    bool parsed = JsonRpcProtocol::parse(data, data + size, request);
+    if (sampled) m_parseLatency.record(std::chrono::steady_clock::now() - parseStart);
+    if (!parsed) {
+        m_requestErrors.add(-32700);
+        response = JsonRpcProtocol::createErrorResponse(-32700, "Parse error", 0);
+    } else if (request.isArray()) {
+        response = handleBatchRequest(request, received);
+    } else if (!request.isMember("method") || !request["method"].isString()) {
+        m_requestErrors.add(-32600);
+        response = JsonRpcProtocol::createErrorResponse(-32600, "Invalid Request", request["id"].asInt());
+    } else if (detach && dispatchCoroutine(request, encoding, detach, received)) {
+        return std::nullopt;
     } else {
-        result = handleRequestAsync(request);
+        response = dispatch(request, received);
+    }
+    auto serializeStart = sampled ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+    std::string result = JsonRpcProtocol::serialize(response, m_outputStyle, encoding);
+    if (sampled) m_serializeLatency.record(std::chrono::steady_clock::now() - serializeStart);
+    if (encoding == JsonRpcProtocol::Encoding::Json) {
+        LOG_DEBUG("{}", result);
     }
-    LOG_DEBUG(result.c_str());
     return result;
 }
 
-std::string JsonRpcServer::handleBatchRequest(const Json::Value &batchRequest) {
-
+#ifdef JSONRPC_USE_SIMDJSON
+inline std::optional<std::string> JsonRpcServer::processView(const char *data, size_t size,
+                                                             std::chrono::steady_clock::time_point received,
+                                                             bool sampled) {
+    // 请求对象与参数各用一个解析器，解码参数时请求对象中读出的方法名等字符串仍然有效
+    thread_local simdjson::ondemand::parser requestParser;
+    thread_local simdjson::ondemand::parser paramsParser;
+    thread_local std::string input;
+    auto parseStart = sampled ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+    input.reserve(size + simdjson::SIMDJSON_PADDING);
+    input.assign(data, size);
+    simdjson::ondemand::document document;
+    simdjson::ondemand::object object;
+    if (requestParser.iterate(input.data(), size, input.capacity()).get(document) ||
+        document.get_object().get(object)) {
+        return std::nullopt;
+    }
+    std::string_view method;
+    std::string_view userPermission;
+    std::string_view params;
+    bool hasMethod = false;
+    int id = 0;
+    std::optional<double> timeout;
+    for (auto field: object) {
+        std::string_view key;
+        simdjson::ondemand::value value;
+        if (field.unescaped_key().get(key) || field.value().get(value)) return std::nullopt;
+        if (key == "method") {
+            if (value.get_string().get(method)) return std::nullopt;
+            hasMethod = true;
+        } else if (key == "params") {
+            if (value.raw_json().get(params)) return std::nullopt;
+        } else if (key == "id") {
+            // 与 asInt() 一致：null 为 0，其他非 int 的 id 交给通用路径
+            simdjson::ondemand::json_type type;
+            int64_t number = 0;
+            if (value.type().get(type)) return std::nullopt;
+            if (type != simdjson::ondemand::json_type::null &&
+                (value.get_int64().get(number) || number < std::numeric_limits<int>::min() ||
+                 number > std::numeric_limits<int>::max())) {
+                return std::nullopt;
+            }
+            id = static_cast<int>(number);
+        } else if (key == "userPermission") {
+            if (value.get_string().get(userPermission)) return std::nullopt;
+        } else if (key == "timeout") {
+            double millis = 0;
+            if (!value.get_double().get(millis)) timeout = millis;
+        } else if (key == "async") {
+            bool async = false;
+            if (value.get_bool().get(async) || async) return std::nullopt;
+        } else if (key == "ack") {
+            return std::nullopt;
+        }
+    }
+    if (!document.at_end() || !hasMethod || method == "getAsyncResult" || method == "getMetrics") {
+        return std::nullopt;
+    }
+    EpochReclaimer::Guard guard;
+    const RpcMethodInfo *methodInfo = findMethod(method);
+    if (methodInfo == nullptr || methodInfo->coroutine || !methodInfo->method.hasView()) return std::nullopt;
+    // 参数原文位于请求缓冲区内，其后的内容与填充足够作为 simdjson 要求的填充
+    simdjson::ondemand::document paramsDocument;
+    simdjson::ondemand::value paramsValue;
+    JsonParamsView view;
+    if (!params.empty()) {
+        auto capacity = static_cast<size_t>(input.data() + input.capacity() - params.data());
+        if (paramsParser.iterate(params.data(), params.size(), capacity).get(paramsDocument) ||
+            paramsDocument.get_value().get(paramsValue)) {
+            return std::nullopt;
+        }
+        view.value = &paramsValue;
+    }
+    auto parseEnd = sampled ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+    Json::Value response;
+    if (timeout && pastDeadline(*timeout, received)) {
+        m_requestErrors.add(-32003);
+        response = JsonRpcProtocol::createErrorResponse(-32003, "Deadline exceeded", id);
+    } else {
+        response = invokeChecked(*methodInfo, userPermission, id, [&] {
+            return invokeMeasured(methodInfo->method, view, *methodInfo->metrics);
+        });
+    }
+    auto serializeStart = sampled ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+    std::string result = JsonRpcProtocol::serialize(response, m_outputStyle, JsonRpcProtocol::Encoding::Json);
+    if (sampled) {
+        m_parseLatency.record(parseEnd - parseStart);
+        m_serializeLatency.record(std::chrono::steady_clock::now() - serializeStart);
+    }
+    return result;
+}
+#endif
 
-    Json::Value batchResponse(Json::arrayValue);
-    for (const auto &request: batchRequest) {
-        std::string result;
-        if (!request["async"].asBool()) {
-            result = handleRequest(request);
-        } else {
-            result = handleRequestAsync(request);
+inline Json::Value JsonRpcServer::dispatch(const Json::Value &request, std::chrono::steady_clock::time_point received) {
+    try {
+        if (request.isMember("ack")) {
+            acknowledge(request);
+        }
+        if (pastDeadline(request, received)) {
+            m_requestErrors.add(-32003);
+            return JsonRpcProtocol::createErrorResponse(-32003, "Deadline exceeded", request["id"].asInt());
         }
-        Json::Value response;
-        std::istringstream(result) >> response;
-        batchResponse.append(response);
+        // 要求推送而未开启推送时按同步请求处理，回复即为结果，客户端不会空等一个永远不来的推送
+        if (request["async"].asBool() && !(request["notify"].asBool() && !m_pubSocket)) {
+            return handleRequestAsync(request);
+        }
+        return handleRequest(request);
+    } catch (const std::exception &e) {
+        m_requestErrors.add(-32603);
+        return JsonRpcProtocol::createErrorResponse(-32603, "Internal error: " + std::string(e.what()), 0);
     }
+}
 
-    return batchResponse.toStyledString();
+inline bool JsonRpcServer::dispatchCoroutine(const Json::Value &request, JsonRpcProtocol::Encoding encoding,
+                                      const std::function<Replier()> &detach,
+                                      std::chrono::steady_clock::time_point received) {
+    if (request["async"].asBool() || pastDeadline(request, received)) return false;
+    EpochReclaimer::Guard guard;
+    const RpcMethodInfo *methodInfo = findMethod(stringView(request["method"]));
+    // 方法不存在、权限不足或参数错误时回到同步路径生成错误响应
+    if (methodInfo == nullptr || !methodInfo->coroutine ||
+        !checkPermission(*methodInfo, stringView(request["userPermission"]))) {
+        return false;
+    }
+    // 被拒绝时同样回到同步路径，由 handleRequest 再次检查并生成 -32002
+    auto permit = std::make_shared<Permit>(admit(*methodInfo));
+    if (!*permit) {
+        return false;
+    }
+    std::optional<Task<Json::Value>> task;
+    try {
+        task.emplace((*methodInfo->coroutine)(request["params"]));
+    } catch (const std::exception &) {
+        return false;
+    }
+    m_loop->spawn(std::move(*task), [this, id = request["id"].asInt(), encoding, reply = detach(), permit,
+            metrics = methodInfo->metrics, coroutine = methodInfo->coroutine, start = std::chrono::steady_clock::now()](
+            std::exception_ptr error, std::optional<Json::Value> result) {
+        metrics->record(std::chrono::steady_clock::now() - start, errorCode(error));
+        *permit = Permit();
+        reply(JsonRpcProtocol::serialize(completionResponse(error, result, id), m_outputStyle, encoding));
+    });
+    return true;
 }
 
-// 成员函数版本
-template<typename Func, typename C>
-void JsonRpcServer::registerMethod(const std::string &method, Func func, C *instance, bool overwrite,
-                                   const std::string &requiredPermission) {
-    if (method == "getAsyncResult") {
-        std::cerr << "getAsyncResult is used" << std::endl;
-        return;
+inline int JsonRpcServer::errorCode(std::exception_ptr error) {
+    if (!error) return 0;
+    try {
+        std::rethrow_exception(error);
+    } catch (const std::invalid_argument &) {
+        return -32602;
+    } catch (const zmq::error_t &) {
+        return -32000;
+    } catch (...) {
+        return -32603;
     }
+}
 
-    using traits = function_traits<Func>;
+inline Json::Value JsonRpcServer::completionResponse(std::exception_ptr error, const std::optional<Json::Value> &result,
+                                              int id) {
+    if (!error) {
+        return JsonRpcProtocol::createResponse(*result, id);
+    }
+    try {
+        std::rethrow_exception(error);
+    } catch (const std::invalid_argument &e) {
+        return JsonRpcProtocol::createErrorResponse(-32602, "Invalid parameters: " + std::string(e.what()), id);
+    } catch (const zmq::error_t &e) {
+        return JsonRpcProtocol::createErrorResponse(-32000, "ZeroMQ error: " + std::string(e.what()), id);
+    } catch (const std::exception &e) {
+        return JsonRpcProtocol::createErrorResponse(-32603, "Internal error: " + std::string(e.what()), id);
+    } catch (...) {
+        return JsonRpcProtocol::createErrorResponse(-32603, "Internal error", id);
+    }
+}
 
-    LOG_DEBUG(std::format("register method :{}", method).c_str())
-    if (methods.find(method) != methods.end() && !overwrite) {
+inline Json::Value JsonRpcServer::handleBatchRequest(const Json::Value &batchRequest,
+                                              std::chrono::steady_clock::time_point received) {
+    Json::Value batchResponse(Json::arrayValue);
+    if (m_batchParallelThreshold == 0 || batchRequest.size() < m_batchParallelThreshold) {
+        for (const auto &request: batchRequest) {
+            batchResponse.append(dispatch(request, received));
+        }
+        return batchResponse;
+    }
+    // 各条目相互独立，扇出到线程池；被拒绝的条目在收集时由当前线程直接处理
+    std::vector<std::optional<std::future<Json::Value>>> futures;
+    futures.reserve(batchRequest.size());
+    for (const auto &request: batchRequest) {
+        futures.push_back(m_executor->trySubmit([this, &request, received] { return dispatch(request, received); }));
+    }
+    for (Json::ArrayIndex i = 0; i < batchRequest.size(); ++i) {
+        batchResponse.append(futures[i] ? futures[i]->get() : dispatch(batchRequest[i], received));
+    }
+    return batchResponse;
+}
+
+inline void JsonRpcServer::addMethod(const std::string &method, RpcMethodInfo info, bool overwrite) {
+    if (method == "getAsyncResult" || method == "getMetrics") {
+        std::cerr << method << " is used" << std::endl;
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_registerMtx);
+    const MethodTable *current = m_methodTable.get();
+    const RpcMethodInfo *existing = current->find(method);
+    if (existing != nullptr && !overwrite) {
         throw std::runtime_error("Method already registered");
     }
+    if (existing != nullptr) {
+        // 覆盖注册沿用原来的并发上限与统计，旧版本仍在执行的调用照常归还名额
+        info.maxConcurrency = existing->maxConcurrency;
+        info.metrics = existing->metrics;
+    } else {
+        info.metrics = std::make_shared<MethodMetrics>();
+    }
+    publishMethods(std::make_unique<MethodTable>(current->with(method, std::move(info))));
+}
 
-    // 创建包装器，将 JSON 参数转换为函数所需的参数
-    auto wrapper = [instance, func](const Json::Value &params) -> Json::Value {
-        if (params.size() != traits::arity) {
-            throw std::runtime_error("Incorrect number of arguments");
-        }
+inline void JsonRpcServer::setMethodConcurrency(const std::string &method, size_t limit) {
+    std::lock_guard<std::mutex> lock(m_registerMtx);
+    const MethodTable *current = m_methodTable.get();
+    const RpcMethodInfo *existing = current->find(method);
+    if (existing == nullptr) {
+        throw std::runtime_error("Method not registered");
+    }
+    RpcMethodInfo info = *existing;
+    info.maxConcurrency = limit;
+    publishMethods(std::make_unique<MethodTable>(current->with(method, std::move(info))));
+}
 
-        // 调用成员函数并将 instance 和 func 传递给 invoke
-        return invoke<C, Func>(instance, func, params, std::make_index_sequence<traits::arity>{});
+inline void JsonRpcServer::publishMethods(std::unique_ptr<MethodTable> table) {
+    m_methods.store(table.get(), std::memory_order_seq_cst);
+    m_retiredTables.retire(std::exchange(m_methodTable, std::move(table)));
+}
+
+inline EventLoop &JsonRpcServer::eventLoop() {
+    std::lock_guard<std::mutex> lock(m_registerMtx);
+    if (!m_loop) {
+        m_loop = std::make_unique<EventLoop>();
+    }
+    return *m_loop;
+}
+
+template<typename Call>
+void JsonRpcServer::addCoroutineMethod(const std::string &method, Call call, bool overwrite,
+                                       const std::string &requiredPermission) {
+    EventLoop *loop = &eventLoop();
+    // 先复制参数再解码，协程挂起后解码出的 string_view 等仍然有效；参数错误在启动前同步抛出
+    // 各代方法表与运行中的协程共享同一个可调用对象，协程帧可能引用其中捕获的状态
+    auto coroutine = std::make_shared<const CoroutineMethod>([call](const Json::Value &params) {
+        auto owned = std::make_shared<const Json::Value>(params);
+        auto task = call(*owned);
+        return encodeTask(std::move(task), std::move(owned));
+    });
+    // 单 REP 套接字、批量请求与 process(data, size) 走阻塞版本，在当前线程等待协程结束
+    auto blocking = [loop, coroutine](const Json::Value &params) -> Json::Value {
+        // 事件循环先于协程结束被销毁时 promise 随之释放，等待方得到 broken_promise 而不是永久阻塞
+        auto promise = std::make_shared<std::promise<Json::Value>>();
+        std::future<Json::Value> future = promise->get_future();
+        loop->spawn((*coroutine)(params), [promise](std::exception_ptr error, std::optional<Json::Value> result) {
+            fulfil(*promise, error, std::move(result));
+        });
+        return future.get();
     };
+    addMethod(method, {RpcMethod::wrap(std::move(blocking)), requiredPermission, std::move(coroutine)}, overwrite);
+}
 
-    methods[method] = {wrapper, requiredPermission};
+// 成员函数版本
+template<typename Func, typename C>
+void JsonRpcServer::registerMethod(const std::string &method, Func func, C *instance, bool overwrite,
+                                   const std::string &requiredPermission) {
+    using traits = function_traits<Func>;
+    LOG_DEBUG("register method :{}", method)
+    if constexpr (IsTask<typename traits::return_type>::value) {
+        addCoroutineMethod(method, [instance, func](const Json::Value &params) {
+            return JsonInvoker<typename traits::signature>::invoke(params, func, instance);
+        }, overwrite, requiredPermission);
+    } else {
+        // 创建包装器，将 JSON 参数转换为函数所需的参数
+        auto wrapper = [instance, func](const auto &params) -> Json::Value {
+            return JsonInvoker<typename traits::signature>::call(params, func, instance);
+        };
+        addMethod(method, {RpcMethod::wrap(std::move(wrapper)), requiredPermission}, overwrite);
+    }
 }
 
 
 template<typename Func>
 void JsonRpcServer::registerMethod(const std::string &method, Func func, bool overwrite,
                                    const std::string &requiredPermission) {
-    if (method == "getAsyncResult") {
-        std::cerr << "getAsyncResult is used" << std::endl;
-        return;
-    }
     using traits = function_traits<Func>;
-    LOG_DEBUG(std::format("register method :{}", method).c_str())
-    if (methods.find(method) != methods.end() && !overwrite) {
-        throw std::runtime_error("Method already registered");
+    LOG_DEBUG("register method :{}", method)
+    if constexpr (IsTask<typename traits::return_type>::value) {
+        addCoroutineMethod(method, [func](const Json::Value &params) {
+            return JsonInvoker<typename traits::signature>::invoke(params, func);
+        }, overwrite, requiredPermission);
+    } else {
+        // 创建包装器，将 JSON 参数转换为函数所需的参数
+        auto wrapper = [func](const auto &params) -> Json::Value {
+            return JsonInvoker<typename traits::signature>::call(params, func);
+        };
+        addMethod(method, {RpcMethod::wrap(std::move(wrapper)), requiredPermission}, overwrite);
     }
-    // 创建包装器，将 JSON 参数转换为函数所需的参数
-    auto wrapper = [func](const Json::Value &params) -> Json::Value {
-        if (params.size() != traits::arity) {
-            throw std::runtime_error("Incorrect number of arguments");
-        }
+}
+
+template<auto Func>
+void JsonRpcServer::registerMethod(const std::string &method, bool overwrite, const std::string &requiredPermission) {
+    using traits = function_traits<decltype(Func)>;
+    LOG_DEBUG("register method :{}", method)
+    if constexpr (IsTask<typename traits::return_type>::value) {
+        addCoroutineMethod(method, [](const Json::Value &params) {
+            return JsonInvoker<typename traits::signature>::invoke(params, Func);
+        }, overwrite, requiredPermission);
+    } else {
+        auto call = [](const void *, const auto &params) -> Json::Value {
+            return JsonInvoker<typename traits::signature>::call(params, Func);
+        };
+        addMethod(method, {RpcMethod::bind(call), requiredPermission}, overwrite);
+    }
+}
 
-        //return invokeWithJson<Func, typename traits::template arg<0>, typename traits::template arg<1> /*...更多参数*/>(func, params);
-        return invoke<Func>(func, params, std::make_index_sequence<traits::arity>{});
+template<auto Func, typename C>
+void JsonRpcServer::registerMethod(const std::string &method, C *instance, bool overwrite,
+                                   const std::string &requiredPermission) {
+    using traits = function_traits<decltype(Func)>;
+    LOG_DEBUG("register method :{}", method)
+    if constexpr (IsTask<typename traits::return_type>::value) {
+        addCoroutineMethod(method, [instance](const Json::Value &params) {
+            return JsonInvoker<typename traits::signature>::invoke(params, Func, instance);
+        }, overwrite, requiredPermission);
+    } else {
+        auto call = [](const void *target, const auto &params) -> Json::Value {
+            return JsonInvoker<typename traits::signature>::call(params, Func,
+                                                                 static_cast<C *>(const_cast<void *>(target)));
+        };
+        addMethod(method, {RpcMethod::bind(call, instance), requiredPermission}, overwrite);
+    }
+}
 
-    };
+template<typename Func>
+void JsonRpcServer::registerMethod(const std::string &method, Func func, ParamNames paramNames, bool overwrite,
+                                   const std::string &requiredPermission) {
+    using traits = function_traits<Func>;
+    LOG_DEBUG("register method :{}", method)
+    if (paramNames.size() != traits::arity) {
+        throw std::invalid_argument("Parameter names do not match the number of arguments");
+    }
+    if constexpr (IsTask<typename traits::return_type>::value) {
+        addCoroutineMethod(method, [func, names = std::move(paramNames)](const Json::Value &params) {
+            return JsonInvoker<typename traits::signature>::invokeNamed(params, names, func);
+        }, overwrite, requiredPermission);
+    } else {
+        auto wrapper = [func, names = std::move(paramNames)](const auto &params) -> Json::Value {
+            return JsonInvoker<typename traits::signature>::callNamed(params, names, func);
+        };
+        addMethod(method, {RpcMethod::wrap(std::move(wrapper)), requiredPermission}, overwrite);
+    }
+}
+
+template<typename Func, typename C>
+void JsonRpcServer::registerMethod(const std::string &method, Func func, C *instance, ParamNames paramNames,
+                                   bool overwrite, const std::string &requiredPermission) {
+    using traits = function_traits<Func>;
+    LOG_DEBUG("register method :{}", method)
+    if (paramNames.size() != traits::arity) {
+        throw std::invalid_argument("Parameter names do not match the number of arguments");
+    }
+    if constexpr (IsTask<typename traits::return_type>::value) {
+        addCoroutineMethod(method, [instance, func, names = std::move(paramNames)](const Json::Value &params) {
+            return JsonInvoker<typename traits::signature>::invokeNamed(params, names, func, instance);
+        }, overwrite, requiredPermission);
+    } else {
+        auto wrapper = [instance, func, names = std::move(paramNames)](const auto &params) -> Json::Value {
+            return JsonInvoker<typename traits::signature>::callNamed(params, names, func, instance);
+        };
+        addMethod(method, {RpcMethod::wrap(std::move(wrapper)), requiredPermission}, overwrite);
+    }
+}
 
-    methods[method] = {wrapper, requiredPermission};
+template<auto Func>
+void JsonRpcServer::registerMethod(const std::string &method, ParamNames paramNames, bool overwrite,
+                                   const std::string &requiredPermission) {
+    registerMethod(method, Func, std::move(paramNames), overwrite, requiredPermission);
+}
 
+template<auto Func, typename C>
+void JsonRpcServer::registerMethod(const std::string &method, C *instance, ParamNames paramNames, bool overwrite,
+                                   const std::string &requiredPermission) {
+    registerMethod(method, Func, instance, std::move(paramNames), overwrite, requiredPermission);
 }
 
 #endif // JSON_RPC_SERVER_H
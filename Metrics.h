@@ -0,0 +1,187 @@
+//
+// 无锁的请求计数与对数线性分桶的延迟直方图，记录时只有几次 relaxed 原子操作
+//
+
+#ifndef JSON_RPC_METRICS_H
+#define JSON_RPC_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+
+// 与 HdrHistogram 相同的分桶方式：每个 2 的幂区间再等分为 16 个子桶，相对误差不超过 1/16。
+// 以纳秒记录，覆盖到 2^40 ns（约 18 分钟），更大的值计入最后一个桶
+class LatencyHistogram {
+public:
+    struct Summary {
+        uint64_t count;
+        double meanMicros;
+        double p50Micros;
+        double p90Micros;
+        double p99Micros;
+        double p999Micros;
+        double maxMicros;
+    };
+
+    void record(std::chrono::steady_clock::duration latency) {
+        int64_t ticks = std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count();
+        uint64_t nanos = ticks > 0 ? static_cast<uint64_t>(ticks) : 0;
+        m_buckets[indexOf(nanos)].fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(nanos, std::memory_order_relaxed);
+        uint64_t max = m_max.load(std::memory_order_relaxed);
+        while (nanos > max && !m_max.compare_exchange_weak(max, nanos, std::memory_order_relaxed)) {
+        }
+    }
+
+    // 各计数分别读取，与并发的 record 之间只保证近似一致
+    Summary summary() const;
+
+private:
+    static constexpr int kSubBits = 4;
+    static constexpr uint64_t kSubCount = uint64_t{1} << kSubBits;
+    static constexpr int kMaxExponent = 40;
+    static constexpr size_t kBucketCount = (kMaxExponent - kSubBits + 2) * kSubCount;
+
+    static size_t indexOf(uint64_t nanos) {
+        if (nanos < kSubCount) return static_cast<size_t>(nanos);
+        int exponent = std::bit_width(nanos) - 1;
+        if (exponent > kMaxExponent) return kBucketCount - 1;
+        uint64_t sub = (nanos >> (exponent - kSubBits)) & (kSubCount - 1);
+        return static_cast<size_t>((exponent - kSubBits + 1) * kSubCount + sub);
+    }
+
+    // 桶内的最大值，百分位按此报告
+    static uint64_t upperBound(size_t index) {
+        if (index < kSubCount) return index;
+        int exponent = static_cast<int>(index / kSubCount) + kSubBits - 1;
+        uint64_t sub = index % kSubCount;
+        uint64_t width = uint64_t{1} << (exponent - kSubBits);
+        return ((kSubCount + sub) << (exponent - kSubBits)) + width - 1;
+    }
+
+    std::array<std::atomic<uint64_t>, kBucketCount> m_buckets{};
+    std::atomic<uint64_t> m_sum{0};
+    std::atomic<uint64_t> m_max{0};
+};
+
+inline LatencyHistogram::Summary LatencyHistogram::summary() const {
+    std::array<uint64_t, kBucketCount> counts;
+    uint64_t total = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    Summary summary{};
+    summary.count = total;
+    if (total == 0) return summary;
+    uint64_t max = m_max.load(std::memory_order_relaxed);
+    summary.meanMicros = static_cast<double>(m_sum.load(std::memory_order_relaxed)) /
+                         static_cast<double>(total) / 1000.0;
+    summary.maxMicros = static_cast<double>(max) / 1000.0;
+    // 按百分位从小到大依次扫描一遍
+    const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+    double *outputs[] = {&summary.p50Micros, &summary.p90Micros, &summary.p99Micros, &summary.p999Micros};
+    uint64_t seen = 0;
+    size_t bucket = 0;
+    for (int q = 0; q < 4; ++q) {
+        auto rank = static_cast<uint64_t>(quantiles[q] * static_cast<double>(total - 1)) + 1;
+        while (seen + counts[bucket] < rank) {
+            seen += counts[bucket];
+            ++bucket;
+        }
+        uint64_t value = upperBound(bucket);
+        *outputs[q] = static_cast<double>(value < max ? value : max) / 1000.0;
+    }
+    return summary;
+}
+
+// 按 JSON-RPC 错误码分别计数，未列出的错误码合并计入 0
+class ErrorCounts {
+public:
+    static constexpr std::array<int, 9> kCodes = {-32700, -32600, -32601, -32602, -32603,
+                                                  -32000, -32001, -32002, -32003};
+
+    void add(int code) {
+        size_t slot = kCodes.size();
+        for (size_t i = 0; i < kCodes.size(); ++i) {
+            if (kCodes[i] == code) {
+                slot = i;
+                break;
+            }
+        }
+        m_counts[slot].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 依次以 (code, count) 调用 func，跳过计数为 0 的错误码
+    template<typename F>
+    void forEach(F func) const {
+        for (size_t i = 0; i <= kCodes.size(); ++i) {
+            uint64_t count = m_counts[i].load(std::memory_order_relaxed);
+            if (count != 0) func(i < kCodes.size() ? kCodes[i] : 0, count);
+        }
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, kCodes.size() + 1> m_counts{};
+};
+
+// 延迟采样。两次取时间加一次直方图更新约 100ns，远多于计数本身，因此每个线程在每个计时点上每 period 次只计时一次，
+// 其余调用只计数；延迟分位与均值由样本估计，最大值只来自样本。period 为 1 时每次都计时。进程内共享同一设置
+class LatencySampler {
+public:
+    enum Site {
+        Request,    // 请求解析与响应序列化
+        Method,     // 方法执行
+        kSiteCount
+    };
+
+    static void setPeriod(uint32_t period) { s_period.store(period > 0 ? period : 1, std::memory_order_relaxed); }
+
+    static uint32_t period() { return s_period.load(std::memory_order_relaxed); }
+
+    // 本次调用是否计时；各计时点分别计数，同一线程交替经过多个计时点时互不干扰。调小周期后立即生效
+    static bool sample(Site site) {
+        thread_local std::array<uint32_t, kSiteCount> countdown{};
+        uint32_t current = period();
+        if (countdown[site] != 0 && countdown[site] < current) {
+            --countdown[site];
+            return false;
+        }
+        countdown[site] = current - 1;
+        return true;
+    }
+
+private:
+    static inline std::atomic<uint32_t> s_period{8};
+};
+
+// 单个方法的计数，由各代方法表共享，覆盖注册后保留。调用数为执行数加被拒绝数，延迟直方图只含采样到的执行
+struct MethodMetrics {
+    std::atomic<size_t> inFlight{0};
+    std::atomic<uint64_t> executed{0};
+    std::atomic<uint64_t> rejected{0};
+    ErrorCounts errors;
+    LatencyHistogram latency;
+
+    // 一次计时的执行：code 为 0 表示成功
+    void record(std::chrono::steady_clock::duration elapsed, int code = 0) {
+        count(code);
+        latency.record(elapsed);
+    }
+
+    // 一次未计时的执行
+    void count(int code = 0) {
+        executed.fetch_add(1, std::memory_order_relaxed);
+        if (code != 0) errors.add(code);
+    }
+
+    // 未执行就被拒绝（权限、过载、参数），不计入延迟
+    void reject(int code) {
+        rejected.fetch_add(1, std::memory_order_relaxed);
+        errors.add(code);
+    }
+};
+
+#endif // JSON_RPC_METRICS_H
@@ -0,0 +1,289 @@
+//
+// Json::Value 与 MessagePack 之间的编解码，承载与 JSON 相同的 JSON-RPC 信封
+//
+
+#ifndef JSON_RPC_MSGPACK_CODEC_H
+#define JSON_RPC_MSGPACK_CODEC_H
+
+#include <jsoncpp/json/json.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+class MsgPackCodec {
+public:
+    // 合法 JSON 文本的首字节都是 ASCII，而 MessagePack 的 map/array 首字节均不小于 0x80，据此区分编码
+    static bool isMsgPack(const char *begin, const char *end) {
+        return begin != end && static_cast<unsigned char>(*begin) >= 0x80;
+    }
+
+    static void write(const Json::Value &value, std::string &out) {
+        switch (value.type()) {
+            case Json::nullValue:
+                out.push_back(static_cast<char>(0xc0));
+                break;
+            case Json::booleanValue:
+                out.push_back(static_cast<char>(value.asBool() ? 0xc3 : 0xc2));
+                break;
+            case Json::intValue: {
+                Json::LargestInt number = value.asLargestInt();
+                if (number >= 0) {
+                    writeUnsigned(out, static_cast<uint64_t>(number));
+                } else {
+                    writeSigned(out, number);
+                }
+                break;
+            }
+            case Json::uintValue:
+                writeUnsigned(out, value.asLargestUInt());
+                break;
+            case Json::realValue: {
+                double number = value.asDouble();
+                uint64_t bits;
+                std::memcpy(&bits, &number, sizeof bits);
+                out.push_back(static_cast<char>(0xcb));
+                writeBigEndian(out, bits, 8);
+                break;
+            }
+            case Json::stringValue: {
+                const char *begin = nullptr;
+                const char *end = nullptr;
+                value.getString(&begin, &end);
+                writeString(out, begin, end);
+                break;
+            }
+            case Json::arrayValue: {
+                writeHeader(out, value.size(), 0x90, 0xdc);
+                for (const auto &element: value) {
+                    write(element, out);
+                }
+                break;
+            }
+            case Json::objectValue: {
+                writeHeader(out, value.size(), 0x80, 0xde);
+                for (auto it = value.begin(); it != value.end(); ++it) {
+                    const char *end = nullptr;
+                    const char *begin = it.memberName(&end);
+                    writeString(out, begin, end);
+                    write(*it, out);
+                }
+                break;
+            }
+        }
+    }
+
+    static bool parse(const char *begin, const char *end, Json::Value &out, std::string *errs) {
+        Reader reader{reinterpret_cast<const uint8_t *>(begin), reinterpret_cast<const uint8_t *>(end)};
+        if (!reader.read(out, 0) || reader.pos != reader.end) {
+            if (errs) *errs = "invalid MessagePack payload";
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static constexpr int MAX_DEPTH = 512;
+
+    static void writeBigEndian(std::string &out, uint64_t value, int bytes) {
+        for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8) {
+            out.push_back(static_cast<char>((value >> shift) & 0xff));
+        }
+    }
+
+    static void writeUnsigned(std::string &out, uint64_t number) {
+        if (number < 0x80) {
+            out.push_back(static_cast<char>(number));
+        } else if (number <= UINT8_MAX) {
+            out.push_back(static_cast<char>(0xcc));
+            writeBigEndian(out, number, 1);
+        } else if (number <= UINT16_MAX) {
+            out.push_back(static_cast<char>(0xcd));
+            writeBigEndian(out, number, 2);
+        } else if (number <= UINT32_MAX) {
+            out.push_back(static_cast<char>(0xce));
+            writeBigEndian(out, number, 4);
+        } else {
+            out.push_back(static_cast<char>(0xcf));
+            writeBigEndian(out, number, 8);
+        }
+    }
+
+    static void writeSigned(std::string &out, int64_t number) {
+        if (number >= -32) {
+            out.push_back(static_cast<char>(number));
+        } else if (number >= INT8_MIN) {
+            out.push_back(static_cast<char>(0xd0));
+            writeBigEndian(out, static_cast<uint64_t>(number), 1);
+        } else if (number >= INT16_MIN) {
+            out.push_back(static_cast<char>(0xd1));
+            writeBigEndian(out, static_cast<uint64_t>(number), 2);
+        } else if (number >= INT32_MIN) {
+            out.push_back(static_cast<char>(0xd2));
+            writeBigEndian(out, static_cast<uint64_t>(number), 4);
+        } else {
+            out.push_back(static_cast<char>(0xd3));
+            writeBigEndian(out, static_cast<uint64_t>(number), 8);
+        }
+    }
+
+    static void writeString(std::string &out, const char *begin, const char *end) {
+        auto size = static_cast<uint64_t>(end - begin);
+        if (size < 32) {
+            out.push_back(static_cast<char>(0xa0 | size));
+        } else if (size <= UINT8_MAX) {
+            out.push_back(static_cast<char>(0xd9));
+            writeBigEndian(out, size, 1);
+        } else if (size <= UINT16_MAX) {
+            out.push_back(static_cast<char>(0xda));
+            writeBigEndian(out, size, 2);
+        } else {
+            out.push_back(static_cast<char>(0xdb));
+            writeBigEndian(out, size, 4);
+        }
+        out.append(begin, end);
+    }
+
+    // fixBase 为 fixarray/fixmap 前缀，wideBase 为对应的 16 位长度前缀（32 位前缀为其加一）
+    static void writeHeader(std::string &out, uint64_t size, uint8_t fixBase, uint8_t wideBase) {
+        if (size < 16) {
+            out.push_back(static_cast<char>(fixBase | size));
+        } else if (size <= UINT16_MAX) {
+            out.push_back(static_cast<char>(wideBase));
+            writeBigEndian(out, size, 2);
+        } else {
+            out.push_back(static_cast<char>(wideBase + 1));
+            writeBigEndian(out, size, 4);
+        }
+    }
+
+    struct Reader {
+        const uint8_t *pos;
+        const uint8_t *end;
+
+        bool readBigEndian(int bytes, uint64_t &value) {
+            if (end - pos < bytes) return false;
+            value = 0;
+            for (int i = 0; i < bytes; ++i) {
+                value = (value << 8) | *pos++;
+            }
+            return true;
+        }
+
+        bool readString(uint64_t size, Json::Value &out) {
+            if (static_cast<uint64_t>(end - pos) < size) return false;
+            auto *begin = reinterpret_cast<const char *>(pos);
+            out = Json::Value(begin, begin + size);
+            pos += size;
+            return true;
+        }
+
+        bool readArray(uint64_t size, Json::Value &out, int depth) {
+            out = Json::Value(Json::arrayValue);
+            for (uint64_t i = 0; i < size; ++i) {
+                if (!read(out.append(Json::Value()), depth + 1)) return false;
+            }
+            return true;
+        }
+
+        bool readMap(uint64_t size, Json::Value &out, int depth) {
+            out = Json::Value(Json::objectValue);
+            for (uint64_t i = 0; i < size; ++i) {
+                Json::Value key;
+                if (!read(key, depth + 1) || !key.isString()) return false;
+                const char *keyBegin = nullptr;
+                const char *keyEnd = nullptr;
+                key.getString(&keyBegin, &keyEnd);
+                if (!read(*out.demand(keyBegin, keyEnd), depth + 1)) return false;
+            }
+            return true;
+        }
+
+        bool read(Json::Value &out, int depth) {
+            if (pos == end || depth > MAX_DEPTH) return false;
+            uint8_t tag = *pos++;
+            uint64_t value = 0;
+            // 非负整数与 jsoncpp 解析 JSON 时一致，能放进有符号类型时用 intValue
+            if (tag < 0x80) {
+                out = Json::Value(static_cast<Json::Int>(tag));
+                return true;
+            }
+            if (tag >= 0xe0) {
+                out = Json::Value(static_cast<Json::Int>(static_cast<int8_t>(tag)));
+                return true;
+            }
+            if ((tag & 0xe0) == 0xa0) return readString(tag & 0x1f, out);
+            if ((tag & 0xf0) == 0x90) return readArray(tag & 0x0f, out, depth);
+            if ((tag & 0xf0) == 0x80) return readMap(tag & 0x0f, out, depth);
+            switch (tag) {
+                case 0xc0:
+                    out = Json::Value(Json::nullValue);
+                    return true;
+                case 0xc2:
+                case 0xc3:
+                    out = Json::Value(tag == 0xc3);
+                    return true;
+                case 0xc4:
+                case 0xd9:
+                    return readBigEndian(1, value) && readString(value, out);
+                case 0xc5:
+                case 0xda:
+                    return readBigEndian(2, value) && readString(value, out);
+                case 0xc6:
+                case 0xdb:
+                    return readBigEndian(4, value) && readString(value, out);
+                case 0xca: {
+                    if (!readBigEndian(4, value)) return false;
+                    auto bits = static_cast<uint32_t>(value);
+                    float number;
+                    std::memcpy(&number, &bits, sizeof number);
+                    out = Json::Value(static_cast<double>(number));
+                    return true;
+                }
+                case 0xcb: {
+                    if (!readBigEndian(8, value)) return false;
+                    double number;
+                    std::memcpy(&number, &value, sizeof number);
+                    out = Json::Value(number);
+                    return true;
+                }
+                case 0xcc:
+                case 0xcd:
+                case 0xce:
+                case 0xcf:
+                    if (!readBigEndian(1 << (tag - 0xcc), value)) return false;
+                    out = value <= static_cast<uint64_t>(INT64_MAX) ? Json::Value(static_cast<Json::Int64>(value))
+                                                                    : Json::Value(static_cast<Json::UInt64>(value));
+                    return true;
+                case 0xd0:
+                    if (!readBigEndian(1, value)) return false;
+                    out = Json::Value(static_cast<Json::Int64>(static_cast<int8_t>(value)));
+                    return true;
+                case 0xd1:
+                    if (!readBigEndian(2, value)) return false;
+                    out = Json::Value(static_cast<Json::Int64>(static_cast<int16_t>(value)));
+                    return true;
+                case 0xd2:
+                    if (!readBigEndian(4, value)) return false;
+                    out = Json::Value(static_cast<Json::Int64>(static_cast<int32_t>(value)));
+                    return true;
+                case 0xd3:
+                    if (!readBigEndian(8, value)) return false;
+                    out = Json::Value(static_cast<Json::Int64>(value));
+                    return true;
+                case 0xdc:
+                    return readBigEndian(2, value) && readArray(value, out, depth);
+                case 0xdd:
+                    return readBigEndian(4, value) && readArray(value, out, depth);
+                case 0xde:
+                    return readBigEndian(2, value) && readMap(value, out, depth);
+                case 0xdf:
+                    return readBigEndian(4, value) && readMap(value, out, depth);
+                default:
+                    // ext 类型无法映射到 JSON
+                    return false;
+            }
+        }
+    };
+};
+
+#endif // JSON_RPC_MSGPACK_CODEC_H
@@ -0,0 +1,192 @@
+//
+// 固定大小的工作窃取线程池，用于执行异步 RPC 请求
+//
+
+#ifndef JSON_RPC_THREAD_POOL_H
+#define JSON_RPC_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+class ThreadPool {
+public:
+    struct Stats {
+        size_t threads;
+        size_t queued;          // 当前排队任务数
+        size_t maxQueued;       // 排队上限
+        uint64_t executed;
+        uint64_t steals;
+        uint64_t rejected;
+    };
+
+    explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency(), size_t maxQueued = 1024);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // 队列已满时返回 std::nullopt，由调用方决定如何拒绝
+    template<typename F>
+    auto trySubmit(F &&func) -> std::optional<std::future<std::invoke_result_t<std::decay_t<F>>>>;
+
+    Stats stats() const;
+
+    size_t size() const { return m_queues.size(); }
+
+private:
+    using Task = std::function<void()>;
+
+    // 每个工作线程一个双端队列：本线程从头部取，窃取者从尾部取
+    struct alignas(64) WorkQueue {
+        std::mutex mtx;
+        std::deque<Task> tasks;
+    };
+
+    void workerLoop(size_t index);
+
+    bool popLocal(size_t index, Task &task);
+
+    bool steal(size_t index, Task &task);
+
+    bool reserveSlot();
+
+    void push(Task task);
+
+private:
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+    std::vector<std::thread> m_threads;
+    const size_t m_maxQueued;
+    std::atomic<size_t> m_queued{0};
+    std::atomic<size_t> m_next{0};
+    std::atomic<uint64_t> m_executed{0};
+    std::atomic<uint64_t> m_steals{0};
+    std::atomic<uint64_t> m_rejected{0};
+    std::mutex m_sleepMtx;
+    std::condition_variable m_sleepCond;
+    bool m_stop = false;
+
+    // 当前线程所属的线程池及其队列下标，用于工作线程内部提交时直接压入本地队列
+    static thread_local ThreadPool *t_pool;
+    static thread_local size_t t_index;
+};
+
+inline thread_local ThreadPool *ThreadPool::t_pool = nullptr;
+inline thread_local size_t ThreadPool::t_index = 0;
+
+inline ThreadPool::ThreadPool(size_t threadCount, size_t maxQueued) : m_maxQueued(maxQueued > 0 ? maxQueued : 1) {
+    if (threadCount == 0) threadCount = 1;
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_queues.push_back(std::make_unique<WorkQueue>());
+    }
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_threads.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+inline ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMtx);
+        m_stop = true;
+    }
+    m_sleepCond.notify_all();
+    for (auto &thread: m_threads) {
+        if (thread.joinable()) thread.join();
+    }
+}
+
+template<typename F>
+auto ThreadPool::trySubmit(F &&func) -> std::optional<std::future<std::invoke_result_t<std::decay_t<F>>>> {
+    using R = std::invoke_result_t<std::decay_t<F>>;
+    if (!reserveSlot()) {
+        m_rejected.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+    // std::function 要求可拷贝，packaged_task 只能移动，因此用 shared_ptr 包一层
+    auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(func));
+    auto future = task->get_future();
+    push([task] { (*task)(); });
+    return future;
+}
+
+inline bool ThreadPool::reserveSlot() {
+    size_t queued = m_queued.load(std::memory_order_relaxed);
+    do {
+        if (queued >= m_maxQueued) return false;
+    } while (!m_queued.compare_exchange_weak(queued, queued + 1, std::memory_order_acq_rel));
+    return true;
+}
+
+inline void ThreadPool::push(Task task) {
+    size_t index = t_pool == this ? t_index : m_next.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+    {
+        std::lock_guard<std::mutex> lock(m_queues[index]->mtx);
+        m_queues[index]->tasks.push_back(std::move(task));
+    }
+    // 先获取再释放睡眠锁，避免工作线程检查谓词后、进入等待前丢失唤醒
+    { std::lock_guard<std::mutex> lock(m_sleepMtx); }
+    m_sleepCond.notify_one();
+}
+
+inline bool ThreadPool::popLocal(size_t index, Task &task) {
+    auto &queue = *m_queues[index];
+    std::lock_guard<std::mutex> lock(queue.mtx);
+    if (queue.tasks.empty()) return false;
+    task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    return true;
+}
+
+inline bool ThreadPool::steal(size_t index, Task &task) {
+    for (size_t i = 1; i < m_queues.size(); ++i) {
+        auto &queue = *m_queues[(index + i) % m_queues.size()];
+        std::unique_lock<std::mutex> lock(queue.mtx, std::try_to_lock);
+        if (!lock.owns_lock() || queue.tasks.empty()) continue;
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        m_steals.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+inline void ThreadPool::workerLoop(size_t index) {
+    t_pool = this;
+    t_index = index;
+    while (true) {
+        Task task;
+        if (popLocal(index, task) || steal(index, task)) {
+            m_queued.fetch_sub(1, std::memory_order_acq_rel);
+            task();
+            m_executed.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m_sleepMtx);
+        if (m_stop && m_queued.load(std::memory_order_acquire) == 0) return;
+        // 计数不为 0 说明有任务正在入队或只是窃取时 try_lock 失败，重新扫描即可
+        m_sleepCond.wait(lock, [this] { return m_stop || m_queued.load(std::memory_order_acquire) > 0; });
+        if (m_stop && m_queued.load(std::memory_order_acquire) == 0) return;
+    }
+}
+
+inline ThreadPool::Stats ThreadPool::stats() const {
+    return {m_queues.size(),
+            m_queued.load(std::memory_order_relaxed),
+            m_maxQueued,
+            m_executed.load(std::memory_order_relaxed),
+            m_steals.load(std::memory_order_relaxed),
+            m_rejected.load(std::memory_order_relaxed)};
+}
+
+#endif // JSON_RPC_THREAD_POOL_H
@@ -0,0 +1,18 @@
+//
+// std::string 与 zmq::message_t 之间的零拷贝转换
+//
+
+#ifndef JSON_RPC_ZMQ_MESSAGE_H
+#define JSON_RPC_ZMQ_MESSAGE_H
+
+#include <string>
+#include <zmq.hpp>
+
+// 把 payload 移到堆上并将所有权交给 ZMQ，发送完成后由 ZMQ 回调释放，用户态不再拷贝负载
+inline zmq::message_t takeMessage(std::string &&payload) {
+    auto *buffer = new std::string(std::move(payload));
+    return zmq::message_t(buffer->data(), buffer->size(),
+                          [](void *, void *hint) { delete static_cast<std::string *>(hint); }, buffer);
+}
+
+#endif // JSON_RPC_ZMQ_MESSAGE_H
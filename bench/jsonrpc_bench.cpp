@@ -0,0 +1,291 @@
+//
+// 微基准：请求解析、分派与序列化（JSON 后端随 JSONRPC_USE_SIMDJSON），批量请求，日志写入，MpmcQueue 与 Buffer
+//
+
+#include <benchmark/benchmark.h>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "JsonRpcServer.h"
+#include "Metrics.h"
+#include "log/mpmcqueue.h"
+#include "log/buffer.h"
+#include "log/log.h"
+
+namespace {
+
+int add(int a, int b) {
+    return a + b;
+}
+
+double sum(const std::vector<double> &values) {
+    double total = 0;
+    for (double value: values) total += value;
+    return total;
+}
+
+// 参数为 count 个浮点数组成的数组
+std::string sumRequest(int64_t count) {
+    std::string params;
+    for (int64_t i = 0; i < count; ++i) {
+        if (i != 0) params += ", ";
+        params += std::to_string(i) + ".25";
+    }
+    return R"({"jsonrpc": "2.0", "method": "sum", "params": [[)" + params + R"(]], "id": 1})";
+}
+
+const std::string kAddRequest = R"({"jsonrpc": "2.0", "method": "add", "params": [5, 7], "id": 1})";
+
+// 各基准共用一个服务器；构造时日志被初始化为 DEBUG 级别，这里调到 INFO，只测请求路径本身
+JsonRpcServer &server() {
+    static JsonRpcServer *instance = [] {
+        auto *s = new JsonRpcServer();
+        s->registerMethod<&add>("add");
+        s->registerMethod<&sum>("sum");
+        Log::Instance()->SetLevel(1);
+        return s;
+    }();
+    return *instance;
+}
+
+std::string batchRequest(int64_t size) {
+    std::string batch = "[";
+    for (int64_t i = 0; i < size; ++i) {
+        if (i != 0) batch += ",";
+        batch += R"({"jsonrpc": "2.0", "method": "add", "params": [5, 7], "id": )" + std::to_string(i) + "}";
+    }
+    return batch + "]";
+}
+
+Json::Value sampleResponse() {
+    Json::Value result(Json::objectValue);
+    result["name"] = "jsonrpc";
+    for (int i = 0; i < 16; ++i) {
+        result["values"].append(i * 1.5);
+    }
+    return JsonRpcProtocol::createResponse(result, 1);
+}
+
+} // namespace
+
+static void BM_Parse(benchmark::State &state) {
+    for (auto _: state) {
+        Json::Value request;
+        JsonRpcProtocol::parse(kAddRequest, request);
+        benchmark::DoNotOptimize(request);
+    }
+}
+BENCHMARK(BM_Parse);
+
+// 参数 0 为紧凑格式，1 为缩进格式；计数器 bytes 为输出长度
+static void BM_Serialize(benchmark::State &state) {
+    auto style = state.range(0) == 0 ? JsonRpcProtocol::OutputStyle::Compact : JsonRpcProtocol::OutputStyle::Styled;
+    Json::Value response = sampleResponse();
+    size_t bytes = 0;
+    for (auto _: state) {
+        std::string out = JsonRpcProtocol::serialize(response, style);
+        bytes = out.size();
+        benchmark::DoNotOptimize(out);
+    }
+    state.counters["bytes"] = static_cast<double>(bytes);
+}
+BENCHMARK(BM_Serialize)->Arg(0)->Arg(1);
+
+// 完整的 process()：解析、查表、参数解码、调用、序列化
+static void BM_Process(benchmark::State &state) {
+    JsonRpcServer &s = server();
+    for (auto _: state) {
+        benchmark::DoNotOptimize(s.process(kAddRequest));
+    }
+}
+BENCHMARK(BM_Process)->ThreadRange(1, 8)->UseRealTime();
+
+// 与 BM_Process 相同，但打开 DEBUG 日志：每个请求与响应都写一行
+static void BM_ProcessDebugLog(benchmark::State &state) {
+    JsonRpcServer &s = server();
+    Log::Instance()->SetLevel(0);
+    for (auto _: state) {
+        benchmark::DoNotOptimize(s.process(kAddRequest));
+    }
+    Log::Instance()->SetLevel(1);
+}
+BENCHMARK(BM_ProcessDebugLog);
+
+static void BM_ProcessMethodNotFound(benchmark::State &state) {
+    JsonRpcServer &s = server();
+    const std::string request = R"({"jsonrpc": "2.0", "method": "missing", "params": [], "id": 1})";
+    for (auto _: state) {
+        benchmark::DoNotOptimize(s.process(request));
+    }
+}
+BENCHMARK(BM_ProcessMethodNotFound);
+
+// 参数量增大时的解码开销，参数为数组长度；以 -DJSONRPC_USE_SIMDJSON 构建时参数直接从解析器视图解码
+static void BM_ProcessArrayParams(benchmark::State &state) {
+    JsonRpcServer &s = server();
+    const std::string request = sumRequest(state.range(0));
+    for (auto _: state) {
+        benchmark::DoNotOptimize(s.process(request));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(request.size()));
+}
+BENCHMARK(BM_ProcessArrayParams)->RangeMultiplier(8)->Range(8, 4096);
+
+// 按条目计吞吐，items_per_second 的倒数即每个条目的开销
+static void BM_ProcessBatch(benchmark::State &state) {
+    JsonRpcServer &s = server();
+    s.setBatchParallelism(0);
+    std::string batch = batchRequest(state.range(0));
+    for (auto _: state) {
+        benchmark::DoNotOptimize(s.process(batch));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ProcessBatch)->RangeMultiplier(4)->Range(1, 1024);
+
+// 改动前的批量路径作对照：每个条目的响应先按缩进格式序列化成字符串，再经 istringstream 解析回 Json::Value
+// 追加到数组，最后整体再缩进序列化一次，即每个条目三遍完整的 JSON 处理。条目请求事先拆好，逐条交给 process()
+static void BM_ProcessBatchReparse(benchmark::State &state) {
+    static JsonRpcServer *styled = [] {
+        server();
+        auto *s = new JsonRpcServer();
+        s->registerMethod<&add>("add");
+        s->registerMethod<&sum>("sum");
+        s->setOutputStyle(JsonRpcProtocol::OutputStyle::Styled);
+        return s;
+    }();
+    std::vector<std::string> elements;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        elements.push_back(R"({"jsonrpc": "2.0", "method": "add", "params": [5, 7], "id": )" + std::to_string(i) + "}");
+    }
+    for (auto _: state) {
+        Json::Value batchResponse(Json::arrayValue);
+        for (const auto &element: elements) {
+            std::istringstream in(styled->process(element));
+            Json::Value response;
+            in >> response;
+            batchResponse.append(std::move(response));
+        }
+        benchmark::DoNotOptimize(batchResponse.toStyledString());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ProcessBatchReparse)->RangeMultiplier(4)->Range(1, 1024);
+
+static void BM_ProcessBatchParallel(benchmark::State &state) {
+    JsonRpcServer &s = server();
+    s.setBatchParallelism(16);
+    std::string batch = batchRequest(state.range(0));
+    for (auto _: state) {
+        benchmark::DoNotOptimize(s.process(batch));
+    }
+    s.setBatchParallelism(0);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ProcessBatchParallel)->RangeMultiplier(4)->Range(16, 1024)->UseRealTime();
+
+// LOG_INFO 的完整开销：级别检查、格式化（二进制格式时为编码）与入队
+static void BM_LogWrite(benchmark::State &state) {
+    server();
+    for (auto _: state) {
+        LOG_INFO("request {} handled in {} us", 42, 7)
+    }
+}
+BENCHMARK(BM_LogWrite)->ThreadRange(1, 8)->UseRealTime();
+
+// 级别被关闭时的开销
+static void BM_LogDisabled(benchmark::State &state) {
+    server();
+    for (auto _: state) {
+        LOG_DEBUG("request {} handled in {} us", 42, 7)
+    }
+}
+BENCHMARK(BM_LogDisabled);
+
+// 每个线程先放后取，多线程时在头尾两个 CAS 上竞争
+static void BM_MpmcQueuePushPop(benchmark::State &state) {
+    static MpmcQueue<int> queue(1 << 16);
+    int item = 0;
+    for (auto _: state) {
+        queue.push(std::move(item));
+        queue.pop(item);
+    }
+}
+BENCHMARK(BM_MpmcQueuePushPop)->ThreadRange(1, 8)->UseRealTime();
+
+// 成批存取，每批各一次 CAS
+static void BM_MpmcQueueBatch(benchmark::State &state) {
+    static MpmcQueue<int> queue(1 << 16);
+    std::vector<int> items(state.range(0));
+    std::vector<int> out;
+    out.reserve(items.size());
+    for (auto _: state) {
+        queue.pushN(items.data(), items.size());
+        while (out.size() < items.size()) {
+            queue.popN(out, items.size() - out.size());
+        }
+        out.clear();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MpmcQueueBatch)->Arg(64)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_BufferAppend(benchmark::State &state) {
+    Buffer buffer;
+    std::string chunk(static_cast<size_t>(state.range(0)), 'x');
+    for (auto _: state) {
+        buffer.Append(chunk);
+        if (buffer.ReadableBytes() > (1 << 20)) buffer.RetrieveAll();
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BufferAppend)->RangeMultiplier(8)->Range(16, 4096);
+
+// 只含直方图与错误计数的更新，不含取时间
+static void BM_HistogramRecord(benchmark::State &state) {
+    static MethodMetrics metrics;
+    int64_t nanos = 100;
+    for (auto _: state) {
+        metrics.record(std::chrono::nanoseconds(nanos));
+        nanos = nanos * 7 % 100003;
+    }
+}
+BENCHMARK(BM_HistogramRecord)->ThreadRange(1, 8)->UseRealTime();
+
+// 每次调用在执行路径上实际增加的开销：与 invokeMeasured 相同，采样到时前后各取一次时间再记录，否则只计数。
+// 参数为采样周期，1 即每次都计时
+static void BM_MetricsPerCall(benchmark::State &state) {
+    static MethodMetrics metrics;
+    uint32_t period = LatencySampler::period();
+    LatencySampler::setPeriod(static_cast<uint32_t>(state.range(0)));
+    for (auto _: state) {
+        bool sampled = LatencySampler::sample(LatencySampler::Method);
+        auto start = sampled ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+        if (sampled) {
+            metrics.record(std::chrono::steady_clock::now() - start);
+        } else {
+            metrics.count();
+        }
+    }
+    LatencySampler::setPeriod(period);
+}
+BENCHMARK(BM_MetricsPerCall)->Arg(1)->Arg(8)->ThreadRange(1, 8)->UseRealTime();
+
+// 日志格式在第一次 init 后固定，二进制日志的开销以 --binary_log 另行运行 BM_LogWrite 测量
+int main(int argc, char **argv) {
+    int kept = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string_view(argv[i]) == "--binary_log") {
+            Log::Instance()->init(1, "./log", ".bin", 1024, true);
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+    argc = kept;
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,178 @@
+//
+// 经回环 TCP 压测服务器：闭环模式下固定并发，每个请求完成后立即发下一个；开环模式下按固定速率发送，
+// 延迟从计划发送时刻算起，服务器变慢时不会因为少发请求而低估延迟。结束时报告吞吐与延迟分位
+//
+
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "JsonRpcClient.h"
+#include "Metrics.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string host = "127.0.0.1";
+    int port = 5555;
+    std::string mode = "closed";
+    int concurrency = 16;           // 闭环模式下的并发请求数
+    double rate = 10000;            // 开环模式下每秒请求数
+    int duration = 10;              // 秒
+    int connections = 1;
+    std::string method = "add";
+    Json::Value params;
+    int timeoutMs = 1000;           // 服务器停顿时闭环线程不会永久等待，0 表示不设超时
+};
+
+struct Results {
+    LatencyHistogram latency;
+    ErrorCounts errors;
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> failed{0};
+    std::atomic<uint64_t> timedOut{0};      // 客户端超时（-32004），不计入延迟与错误
+};
+
+void usage() {
+    std::cerr << "usage: jsonrpc_loadgen [--host 127.0.0.1] [--port 5555] [--mode closed|open]\n"
+                 "                       [--concurrency 16] [--rate 10000] [--duration 10] [--connections 1]\n"
+                 "                       [--method add] [--params '[1, 2]'] [--timeout 1000]\n";
+}
+
+bool parseOptions(int argc, char **argv, Options &options) {
+    options.params = Json::Value(Json::arrayValue);
+    options.params.append(1);
+    options.params.append(2);
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string key = argv[i];
+        std::string value = argv[i + 1];
+        if (key == "--host") options.host = value;
+        else if (key == "--port") options.port = std::atoi(value.c_str());
+        else if (key == "--mode") options.mode = value;
+        else if (key == "--concurrency") options.concurrency = std::atoi(value.c_str());
+        else if (key == "--rate") options.rate = std::atof(value.c_str());
+        else if (key == "--duration") options.duration = std::atoi(value.c_str());
+        else if (key == "--connections") options.connections = std::atoi(value.c_str());
+        else if (key == "--method") options.method = value;
+        else if (key == "--timeout") options.timeoutMs = std::atoi(value.c_str());
+        else if (key == "--params") {
+            if (!JsonRpcProtocol::parse(value, options.params)) {
+                std::cerr << "invalid --params: " << value << std::endl;
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    if (argc % 2 == 0) return false;
+    return (options.mode == "closed" || options.mode == "open") && options.concurrency > 0 && options.rate > 0 &&
+           options.duration > 0 && options.connections > 0;
+}
+
+void record(Results &results, Clock::time_point start, const Json::Value &response) {
+    // 超时的延迟只是超时设置本身，单独计数
+    if (response["error"]["code"].asInt() == -32004) {
+        results.timedOut.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    results.latency.record(Clock::now() - start);
+    if (response.isMember("error")) {
+        results.errors.add(response["error"]["code"].asInt());
+        results.failed.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        results.completed.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// 每个线程同时只有一个未完成的请求
+void runClosed(const Options &options, std::vector<std::unique_ptr<JsonRpcClient>> &clients, Results &results) {
+    Clock::time_point end = Clock::now() + std::chrono::seconds(options.duration);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < options.concurrency; ++i) {
+        JsonRpcClient &client = *clients[i % clients.size()];
+        threads.emplace_back([&options, &client, &results, end] {
+            while (Clock::now() < end) {
+                std::promise<void> done;
+                Clock::time_point start = Clock::now();
+                client.callAsync(options.method, options.params, [&results, &done, start](const Json::Value &response) {
+                    record(results, start, response);
+                    done.set_value();
+                });
+                done.get_future().wait();
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+}
+
+// 按计划时刻发送，不等待回复；结束后等待剩余回复到达或超时
+void runOpen(const Options &options, std::vector<std::unique_ptr<JsonRpcClient>> &clients, Results &results) {
+    auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / options.rate));
+    Clock::time_point begin = Clock::now();
+    Clock::time_point end = begin + std::chrono::seconds(options.duration);
+    uint64_t sent = 0;
+    for (Clock::time_point next = begin; next < end; next += interval) {
+        std::this_thread::sleep_until(next);
+        JsonRpcClient &client = *clients[sent % clients.size()];
+        client.callAsync(options.method, options.params, [&results, next](const Json::Value &response) {
+            record(results, next, response);
+        });
+        ++sent;
+    }
+    Clock::time_point drainUntil = Clock::now() + std::chrono::seconds(5);
+    while (results.completed + results.failed + results.timedOut < sent && Clock::now() < drainUntil) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    uint64_t missing = sent - (results.completed + results.failed + results.timedOut);
+    if (missing != 0) {
+        std::cerr << missing << " requests still outstanding after 5s" << std::endl;
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        usage();
+        return 1;
+    }
+    std::vector<std::unique_ptr<JsonRpcClient>> clients;
+    for (int i = 0; i < options.connections; ++i) {
+        clients.push_back(std::make_unique<JsonRpcClient>());
+        clients.back()->connect(options.host, options.port);
+        clients.back()->setTimeout(std::chrono::milliseconds(options.timeoutMs));
+    }
+    Results results;
+    Clock::time_point start = Clock::now();
+    if (options.mode == "closed") {
+        runClosed(options, clients, results);
+    } else {
+        runOpen(options, clients, results);
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    LatencyHistogram::Summary summary = results.latency.summary();
+    uint64_t completed = results.completed.load();
+    std::cout << "mode        " << options.mode << "\n"
+              << "requests    " << summary.count << " (" << completed << " ok, " << results.failed.load()
+              << " errors)\n"
+              << "timeouts    " << results.timedOut.load() << " (after " << options.timeoutMs << " ms)\n"
+              << "throughput  " << static_cast<double>(summary.count) / elapsed << " req/s\n"
+              << "latency us  mean " << summary.meanMicros << "  p50 " << summary.p50Micros << "  p99 "
+              << summary.p99Micros << "  p999 " << summary.p999Micros << "  max " << summary.maxMicros << "\n";
+    results.errors.forEach([](int code, uint64_t count) {
+        std::cout << "error " << (code == 0 ? std::string("other") : std::to_string(code)) << "  " << count << "\n";
+    });
+    // 客户端析构时丢弃未完成的请求，之后不会再有回调访问 results
+    clients.clear();
+    return 0;
+}
@@ -3,70 +3,73 @@
 //
 
 #include "log.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <ctime>
+#include <cerrno>
+#include <cstdio>
+#include <algorithm>
 
-void Log::init(int level, const char *path, const char *suffix, int maxQueueCapacity) {
-    isOpen_ = true;
+void Log::init(int level, const char *path, const char *suffix, int maxQueueCapacity, bool binary) {
     level_ = level;
-    if (maxQueueCapacity > 0) {
-        isAsync_ = true;
-        if (!deque_) {
-            deque_ = std::make_unique<BlockQueue<std::string>>();
-            writeThread_ = std::make_unique<std::thread>(FlushLogThread);
-        } else { isAsync_ = false; }
-    }
-    lineCount_ = 0;
+    // 重复 init 时先让已入队的行写进旧文件，再切换文件
+    flush();
     auto timer = time(nullptr);
-    auto *systime = localtime(&timer);
-    auto t = systime;
-    path_ = path;
-    suffix_ = suffix;
-    /*
-    char filename[LOG_NAME_LEN] = {0};
-    snprintf(filename, LOG_NAME_LEN - 1, "%s/%04d_%02d_%02d%s",
-             path_, t->tm_year + 1900, t->tm_mon + 1, t->tm_mday, suffix_);
-             */
-    toDay_ = t->tm_mday;
-    auto fileName = std::format("{}/{:04d}_{:02d}_{:02d}{}", path_, t->tm_year + 1900,
-                                t->tm_mon + 1, t->tm_mday, suffix);
+    struct tm t{};
+    localtime_r(&timer, &t);
+    auto fileName = std::format("{}/{:04d}_{:02d}_{:02d}{}", path, t.tm_year + 1900,
+                                t.tm_mon + 1, t.tm_mday, suffix);
     {
-        std::lock_guard<std::mutex> lockGuard(mtx_);
-        buff_.RetrieveAll();
-        if (fp_) {
-            flush();
-            fclose(fp_);
+        // 写线程切换文件时读取 path_ 与 suffix_，与它们的修改互斥
+        std::lock_guard<std::mutex> lockGuard(fileMtx_);
+        path_ = path;
+        suffix_ = suffix;
+        // 格式只由第一次 init 决定：生产者不加锁读取 isBinary_，中途切换会让正在格式化的行按旧格式写进新文件
+        if (!isOpen_.load(std::memory_order_relaxed)) {
+            isBinary_ = binary;
+        } else if (binary != isBinary_.load(std::memory_order_relaxed)) {
+            fprintf(stderr, "Log: format is fixed by the first init, keeping %s records\n",
+                    isBinary_.load(std::memory_order_relaxed) ? "binary" : "text");
         }
-        fp_ = fopen(fileName.c_str(), "a");
-        if (fp_ == nullptr) {
-            mkdir(path_, 0777);
-            fp_ = fopen(fileName.c_str(), "a");
+        toDay_ = t.tm_mday;
+        segment_ = 0;
+        OpenFile_(fileName);
+        // 写线程只创建一次，重复 init 只切换文件、格式与级别
+        if (maxQueueCapacity > 0 && !ring_) {
+            ring_ = std::make_unique<MpmcQueue<std::string>>(maxQueueCapacity);
+            spare_ = std::make_unique<MpmcQueue<std::string>>(maxQueueCapacity);
+            writeThread_ = std::make_unique<std::thread>(FlushLogThread);
         }
-        assert(fp_);
+        isAsync_.store(ring_ != nullptr, std::memory_order_release);
     }
+    isOpen_.store(true, std::memory_order_release);
 }
 
 Log::Log() {
-    lineCount_ = 0;
+    segment_ = 0;
     isAsync_ = false;
+    isOpen_ = false;
+    isBinary_ = false;
+    level_ = 1;
     writeThread_ = nullptr;
-    deque_ = nullptr;
     toDay_ = 0;
-    fp_ = nullptr;
+    fd_ = -1;
+    openFailed_ = false;
+    map_ = nullptr;
+    offset_ = 0;
+    pushed_ = 0;
+    written_ = 0;
+    flushWaiters_ = 0;
 }
 
 Log::~Log() {
-
     if (writeThread_ && writeThread_->joinable()) {
-        while (!deque_->empty()) {
-            deque_->flush();
-        };
-        deque_->close();
+        // 关闭队列后写线程取完剩余的行再退出
+        ring_->close();
         writeThread_->join();
     }
-    if (fp_) {
-        std::lock_guard<std::mutex> locker(mtx_);
-        flush();
-        fclose(fp_);
-    }
+    CloseFile_();
 }
 
 Log *Log::Instance() {
@@ -78,91 +81,226 @@ void Log::FlushLogThread() {
     Log::Instance()->AsyncWrite_();
 }
 
-void Log::write(int level, const char *format, ...) {
-    struct timeval now = {0, 0};
-    gettimeofday(&now, nullptr);
-    auto tSec = now.tv_sec;
-    auto *systime = localtime(&tSec);
-    auto t = systime;
-    va_list vaList;
-    if (toDay_ != t->tm_mday || (lineCount_ % MAX_LINES == 0)) {
-        std::unique_lock<std::mutex> lock(mtx_);
-        lock.unlock();
-        std::string newfile;
-        auto tail = std::format("{:04d}_{:02d}_{:02d}", t->tm_year + 1900, t->tm_mon + 1, t->tm_mday);
-        if (toDay_ != t->tm_mday) {
-            newfile = std::format("{}/{}{}", path_, tail, suffix_);
-            toDay_ = t->tm_mday;
-            lineCount_ = 0;
-        } else {
-            newfile = std::format("{}/{}-{}{}", path_, tail, (lineCount_ / MAX_LINES), suffix_);
-        }
-        lock.lock();
-        flush();
-        fclose(fp_);
-        fp_ = fopen(newfile.c_str(), "a");
-        assert(fp_);
+void Log::AppendPrefix_(std::string &out, int level) {
+    struct timespec now{};
+    clock_gettime(CLOCK_REALTIME, &now);
+    // 日期时间部分每秒每线程只格式化一次，同一秒内的行只追加微秒
+    thread_local time_t stampSec = -1;
+    thread_local char stamp[32];
+    thread_local size_t stampLen = 0;
+    if (now.tv_sec != stampSec) {
+        struct tm t{};
+        localtime_r(&now.tv_sec, &t);
+        stampLen = snprintf(stamp, sizeof stamp, "%d-%02d-%02d %02d:%02d:%02d.",
+                            t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec);
+        stampSec = now.tv_sec;
     }
-    {
-        std::unique_lock<std::mutex> lock(mtx_);
-        lineCount_++;
-        auto n = snprintf(buff_.BeginWrite(), 128, "%d-%02d-%02d %02d:%02d:%02d.%06ld ",
-                          t->tm_year + 1900, t->tm_mon + 1, t->tm_mday,
-                          t->tm_hour, t->tm_min, t->tm_sec, now.tv_usec);
-        buff_.HasWritten(n);
-        AppendLogLevelTitle_(level);
-        va_start(vaList, format);
-        auto m = vsnprintf(buff_.BeginWrite(), buff_.WritableBytes(), format, vaList);
-        va_end(vaList);
-        buff_.HasWritten(m);
-        buff_.Append("\n\0", 2);
-        if (isAsync_ && deque_ && !deque_->full()) {
-            deque_->push_back(buff_.RetrieveAllToStr());
-        } else {
-            fputs(buff_.Peek(),fp_);
-        }
-        buff_.RetrieveAll();
+    char micros[24];
+    int microsLen = snprintf(micros, sizeof micros, "%06ld ", now.tv_nsec / 1000);
+    out.append(stamp, stampLen);
+    out.append(micros, microsLen);
+    out.append(LevelTitle_(level), 9);
+}
+
+std::string Log::TakeSpare_() {
+    std::string line;
+    if (isAsync_.load(std::memory_order_acquire) && spare_->tryPop(line)) {
+        line.clear();
+    } else {
+        line.reserve(256);
+    }
+    return line;
+}
+
+void Log::Submit_(std::string &&line) {
+    if (!isAsync_.load(std::memory_order_acquire)) {
+        std::vector<std::string> lines;
+        lines.push_back(std::move(line));
+        std::lock_guard<std::mutex> lockGuard(fileMtx_);
+        WriteLines_(lines);
+        return;
     }
+    // 队列满时等写线程腾出槽位，不丢行
+    ring_->push(std::move(line));
+    pushed_.fetch_add(1, std::memory_order_relaxed);
 }
-void Log::AppendLogLevelTitle_(int level) {
-    switch(level) {
+
+const char *Log::LevelTitle_(int level) {
+    switch (level) {
         case 0:
-            buff_.Append("[debug]: ", 9);
-            break;
-        case 1:
-            buff_.Append("[info] : ", 9);
-            break;
+            return "[debug]: ";
         case 2:
-            buff_.Append("[warn] : ", 9);
-            break;
+            return "[warn] : ";
         case 3:
-            buff_.Append("[error]: ", 9);
-            break;
+            return "[error]: ";
         default:
-            buff_.Append("[info] : ", 9);
-            break;
+            return "[info] : ";
     }
 }
 
 void Log::flush() {
-    if (isAsync_) deque_->flush();
-    fflush(fp_);
+    if (!isAsync_.load(std::memory_order_acquire)) return;
+    uint64_t target = pushed_.load(std::memory_order_relaxed);
+    if (written_.load(std::memory_order_acquire) >= target) return;
+    // 先登记再检查：写线程要么看到等待者并通知，要么它的进度已被这里看到
+    flushWaiters_.fetch_add(1);
+    {
+        std::unique_lock<std::mutex> lock(flushMtx_);
+        flushCond_.wait(lock, [this, target] { return written_.load() >= target; });
+    }
+    flushWaiters_.fetch_sub(1);
 }
 
-int Log::GetLevel() {
-    std::lock_guard<std::mutex> lockGuard(mtx_);
-    return level_;
+void Log::AsyncWrite_() {
+    std::vector<std::string> batch;
+    batch.reserve(WRITE_BATCH);
+    while (ring_->popN(batch, WRITE_BATCH) > 0) {
+        {
+            std::lock_guard<std::mutex> lockGuard(fileMtx_);
+            WriteLines_(batch);
+        }
+        written_.fetch_add(batch.size());
+        // 写完的串归还给生产者复用，过长的直接释放
+        size_t kept = 0;
+        for (auto &line: batch) {
+            if (line.capacity() > SPARE_CAPACITY) continue;
+            if (&line != &batch[kept]) batch[kept] = std::move(line);
+            ++kept;
+        }
+        spare_->tryPushN(batch.data(), kept);
+        if (flushWaiters_.load() > 0) {
+            // 持锁一下再通知，避免等待者检查条件之后、进入等待之前错过通知
+            { std::lock_guard<std::mutex> lock(flushMtx_); }
+            flushCond_.notify_all();
+        }
+        batch.clear();
+    }
 }
 
-void Log::SetLevel(int level) {
-    std::lock_guard<std::mutex> lockGuard(mtx_);
-    level_=level;
+void Log::WriteLines_(const std::vector<std::string> &lines) {
+    RotateIfNewDay_();
+    for (const auto &line: lines) {
+        Append_(line.data(), line.size());
+    }
 }
 
-void Log::AsyncWrite_() {
-    std::string str;
-    while(deque_->pop(str)) {
-        std::lock_guard<std::mutex> locker(mtx_);
-        fputs(str.c_str(), fp_);
+void Log::Append_(const char *data, size_t len) {
+    if (fd_ < 0) {
+        // 日志文件打不开：文本行改写到 stderr，二进制记录无法直接阅读，丢弃
+        if (!isBinary_.load(std::memory_order_relaxed)) {
+            size_t done = 0;
+            while (done < len) {
+                ssize_t n = ::write(STDERR_FILENO, data + done, len - done);
+                if (n <= 0) break;
+                done += static_cast<size_t>(n);
+            }
+        }
+        return;
+    }
+    // 放不下时换到下一段；空段总能写入，超过段大小的行独占一段
+    while (offset_ != 0 && offset_ + len > SEGMENT_SIZE) {
+        NextSegment_();
+    }
+    if (map_ != nullptr && len <= SEGMENT_SIZE) {
+        memcpy(map_ + offset_, data, len);
+        offset_ += len;
+        return;
+    }
+    // 映射失败或行超过段大小时退回 pwrite
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = pwrite(fd_, data + done, len - done, static_cast<off_t>(offset_ + done));
+        if (n <= 0) break;
+        done += static_cast<size_t>(n);
+    }
+    offset_ += done;
+}
+
+void Log::RotateIfNewDay_() {
+    // 日期每秒只重新计算一次
+    static time_t lastSec = -1;
+    static struct tm t{};
+    auto timer = time(nullptr);
+    if (timer != lastSec) {
+        localtime_r(&timer, &t);
+        lastSec = timer;
+    }
+    if (toDay_ == t.tm_mday) return;
+    toDay_ = t.tm_mday;
+    segment_ = 0;
+    OpenFile_(std::format("{}/{:04d}_{:02d}_{:02d}{}", path_, t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, suffix_));
+}
+
+void Log::NextSegment_() {
+    auto timer = time(nullptr);
+    struct tm t{};
+    localtime_r(&timer, &t);
+    ++segment_;
+    OpenFile_(std::format("{}/{:04d}_{:02d}_{:02d}-{}{}", path_, t.tm_year + 1900, t.tm_mon + 1, t.tm_mday,
+                          segment_, suffix_));
+}
+
+void Log::OpenFile_(const std::string &fileName) {
+    CloseFile_();
+    fd_ = open(fileName.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        mkdir(path_, 0777);
+        fd_ = open(fileName.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    }
+    if (fd_ < 0) {
+        if (!openFailed_) {
+            fprintf(stderr, "Log: cannot open %s: %s, %s\n", fileName.c_str(), strerror(errno),
+                    isBinary_.load(std::memory_order_relaxed) ? "dropping binary records" : "writing to stderr");
+            openFailed_ = true;
+        }
+        offset_ = 0;
+        return;
+    }
+    openFailed_ = false;
+    struct stat st{};
+    fstat(fd_, &st);
+    offset_ = static_cast<size_t>(st.st_size);
+    // 先分配磁盘块再映射：写映射时既不扩展文件，也不会因磁盘写满收到 SIGBUS
+    if (offset_ <= SEGMENT_SIZE && posix_fallocate(fd_, 0, SEGMENT_SIZE) == 0) {
+        void *map = mmap(nullptr, SEGMENT_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (map != MAP_FAILED) {
+            map_ = static_cast<char *>(map);
+            // 进程崩溃后段文件停留在预分配的长度，尾部是零字节：从实际数据之后续写，关闭时截掉其余部分
+            if (offset_ == SEGMENT_SIZE) {
+                offset_ = DataEnd_();
+            }
+        } else {
+            ftruncate(fd_, static_cast<off_t>(offset_));
+        }
+    }
+}
+
+size_t Log::DataEnd_() const {
+    if (isBinary_.load(std::memory_order_relaxed)) {
+        // 按记录长度逐条跳过，遇到零长度或越界的记录为止；记录内部可能含零字节，不能从尾部回扫
+        size_t pos = 0;
+        uint32_t size = 0;
+        while (SEGMENT_SIZE - pos >= sizeof size) {
+            memcpy(&size, map_ + pos, sizeof size);
+            if (size < logrecord::kHeaderSize || size > SEGMENT_SIZE - pos) break;
+            pos += size;
+        }
+        return pos;
+    }
+    // 文本行以换行结尾，不含零字节
+    size_t end = SEGMENT_SIZE;
+    while (end > 0 && map_[end - 1] == '\0') --end;
+    return end;
+}
+
+void Log::CloseFile_() {
+    if (map_ != nullptr) {
+        munmap(map_, SEGMENT_SIZE);
+        map_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ftruncate(fd_, static_cast<off_t>(offset_));
+        close(fd_);
+        fd_ = -1;
     }
 }
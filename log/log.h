@@ -5,78 +5,157 @@
 #ifndef UNTITLED5_LOG_H
 #define UNTITLED5_LOG_H
 
+#include <atomic>
+#include <condition_variable>
 #include <mutex>
 #include <string>
 #include <thread>
 #include <format>
+#include <vector>
+#include <iterator>
 #include <sys/time.h>
+#include <ctime>
 #include <cstring>
-#include <cstdarg>           // vastart va_end
 #include <cassert>
 #include <sys/stat.h>         //mkdir
-#include "blockqueue.h"
 #include "buffer.h"
+#include "mpmcqueue.h"
+#include "logrecord.h"
 
+// 低于该级别的日志在编译期整体剔除，参数既不求值也不格式化
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL 0
+#endif
+
+// 异步模式下调用线程只做格式化与一次无锁入队：时间前缀每秒每线程生成一次，行直接拼在写线程归还的空闲串里
+// 移交给写线程，稳定运行时不再分配内存。写线程把行拷贝进预分配并 mmap 的日志段，段写满或跨天时由它切换到新段。
+// 二进制模式下不做格式化，只把格式串与参数编码成记录，由 jsonrpc_logdecode 离线还原成文本
 class Log {
 public:
+    // 重复调用只切换级别与文件；binary 只在第一次调用时生效，之后与之不同时在 stderr 提示并保持原格式
     void init(int level, const char *path = "./log",
               const char *suffix = ".log",
-              int maxQueueCapacity = 1024);
+              int maxQueueCapacity = 1024,
+              bool binary = false);
 
     static Log *Instance();
 
     static void FlushLogThread();
 
-    void write(int level, const char *format, ...);
+    // std::format 风格，格式串在编译期检查；只应在通过级别检查后调用，参数由 LOG_* 宏延迟求值
+    template<typename... Args>
+    void write(int level, std::format_string<Args...> format, Args &&...args);
 
+    // 等待此前写入的行全部交给操作系统；写线程每写完一批唤醒等待者
     void flush();
 
-    int GetLevel();
+    int GetLevel() const { return level_.load(std::memory_order_relaxed); }
 
-    void SetLevel(int level);
+    void SetLevel(int level) { level_.store(level, std::memory_order_relaxed); }
 
-    bool isOpen() const { return isOpen_; }
+    // acquire：看到已打开时也能看到第一次 init 确定的格式
+    bool isOpen() const { return isOpen_.load(std::memory_order_acquire); }
 
 private:
     Log();
 
-    void AppendLogLevelTitle_(int level);
+    static const char *LevelTitle_(int level);
 
     virtual ~Log();
 
+    // 在 out 后追加 "时间 [级别]: " 前缀
+    static void AppendPrefix_(std::string &out, int level);
+
+    // 取一个写线程归还的空闲串，没有时返回空串
+    std::string TakeSpare_();
+
+    // 同步模式直接写文件，异步模式交给写线程
+    void Submit_(std::string &&line);
+
     void AsyncWrite_();
 
+    // 以下在写线程或同步模式下持有 fileMtx_ 时调用
+    void WriteLines_(const std::vector<std::string> &lines);
+
+    void Append_(const char *data, size_t len);
+
+    void RotateIfNewDay_();
+
+    void NextSegment_();
+
+    // 打开段文件并从已有内容之后继续写，预分配到 SEGMENT_SIZE 后整段映射。
+    // 打不开时在 stderr 报告一次，之后文本行改写到 stderr，二进制记录丢弃，直到下次切换文件成功
+    void OpenFile_(const std::string &fileName);
+
+    // 段已映射且长度为 SEGMENT_SIZE 时，找出实际数据的末尾
+    size_t DataEnd_() const;
+
+    // 解除映射并把文件截断到实际写入的长度
+    void CloseFile_();
+
 private:
     static const int LOG_PATH_LEN = 256;
     static const int LOG_NAME_LEN = 256;
-    static const int MAX_LINES = 50000;
+    static constexpr size_t SEGMENT_SIZE = size_t(64) << 20;
+    static constexpr size_t WRITE_BATCH = 64;
+    // 容量超过它的串不回收，避免偶尔的长行一直占着内存
+    static constexpr size_t SPARE_CAPACITY = 4096;
 
     const char *path_;
     const char *suffix_;
 
-    int MAX_LINES_;
-
-    int lineCount_;
+    int segment_;
     int toDay_;
 
-    bool isOpen_;
-
-    Buffer buff_;
-    int level_;
-    bool isAsync_;
-
-    FILE *fp_;
-    std::unique_ptr<BlockQueue<std::string>> deque_;
+    std::atomic<bool> isOpen_;
+    std::atomic<int> level_;
+    std::atomic<bool> isAsync_;
+    std::atomic<bool> isBinary_;
+
+    int fd_;
+    bool openFailed_;
+    char *map_;
+    // 当前段已写入的长度，映射失败时也按它 pwrite
+    size_t offset_;
+    std::mutex fileMtx_;
+
+    // 写线程空闲时睡在队列里，生产者只在它睡眠时才通知
+    std::unique_ptr<MpmcQueue<std::string>> ring_;
+    // 写完的串由写线程放回这里，生产者取出后清空复用；满时多出的串直接释放
+    std::unique_ptr<MpmcQueue<std::string>> spare_;
     std::unique_ptr<std::thread> writeThread_;
-    std::mutex mtx_;
+    std::atomic<uint64_t> pushed_;
+    std::atomic<uint64_t> written_;
+    // flush 的等待者数，写线程只在有人等待时才加锁通知
+    std::atomic<int> flushWaiters_;
+    std::mutex flushMtx_;
+    std::condition_variable flushCond_;
 };
 
+template<typename... Args>
+void Log::write(int level, std::format_string<Args...> format, Args &&...args) {
+    // 直接拼在回收的串里再整个移交，容量足够时既不分配也不拷贝
+    std::string line = TakeSpare_();
+    if (isBinary_.load(std::memory_order_relaxed)) {
+        struct timespec now{};
+        clock_gettime(CLOCK_REALTIME, &now);
+        logrecord::encode(line, level, static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec,
+                          format.get(), args...);
+    } else {
+        AppendPrefix_(line, level);
+        std::format_to(std::back_inserter(line), format, std::forward<Args>(args)...);
+        line.push_back('\n');
+    }
+    Submit_(std::move(line));
+}
+
 #define LOG_BASE(level, format, ...) \
     do {\
-        Log* log = Log::Instance();\
-        if (log->isOpen() && log->GetLevel() <= level) {\
-            log->write(level, format, ##__VA_ARGS__); \
-            log->flush();\
+        if constexpr ((level) >= LOG_MIN_LEVEL) {\
+            Log* log = Log::Instance();\
+            if (log->isOpen() && log->GetLevel() <= (level)) {\
+                log->write(level, format, ##__VA_ARGS__); \
+            }\
         }\
     } while(0);
 
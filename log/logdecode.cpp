@@ -0,0 +1,223 @@
+//
+// 把二进制日志文件还原成与文本模式相同格式的行：jsonrpc_logdecode <file>...，不给文件时读标准输入
+//
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+#include "logrecord.h"
+
+namespace {
+
+using Arg = std::variant<int64_t, uint64_t, double, std::string, bool, char>;
+
+const char *levelTitle(int level) {
+    switch (level) {
+        case 0:
+            return "[debug]: ";
+        case 2:
+            return "[warn] : ";
+        case 3:
+            return "[error]: ";
+        default:
+            return "[info] : ";
+    }
+}
+
+// 按顺序读取记录内的字段，越界时置 ok = false
+struct Reader {
+    const char *data;
+    size_t size;
+    size_t pos = 0;
+    bool ok = true;
+
+    template<class T>
+    T pod() {
+        T value{};
+        if (pos + sizeof value > size) {
+            ok = false;
+            return value;
+        }
+        memcpy(&value, data + pos, sizeof value);
+        pos += sizeof value;
+        return value;
+    }
+
+    std::string_view bytes(size_t n) {
+        if (pos + n > size) {
+            ok = false;
+            return {};
+        }
+        std::string_view view(data + pos, n);
+        pos += n;
+        return view;
+    }
+};
+
+bool readArg(Reader &reader, Arg &arg) {
+    switch (reader.pod<uint8_t>()) {
+        case logrecord::Int:
+            arg = reader.pod<int64_t>();
+            break;
+        case logrecord::UInt:
+            arg = reader.pod<uint64_t>();
+            break;
+        case logrecord::Double:
+            arg = reader.pod<double>();
+            break;
+        case logrecord::String:
+            arg = std::string(reader.bytes(reader.pod<uint32_t>()));
+            break;
+        case logrecord::Bool:
+            arg = reader.pod<uint8_t>() != 0;
+            break;
+        case logrecord::Char:
+            arg = reader.pod<char>();
+            break;
+        default:
+            return false;
+    }
+    return reader.ok;
+}
+
+std::string formatArg(const Arg &arg, std::string_view spec) {
+    std::string field = "{";
+    if (!spec.empty()) {
+        field += ':';
+        field += spec;
+    }
+    field += '}';
+    return std::visit([&field](const auto &value) {
+        try {
+            return std::vformat(field, std::make_format_args(value));
+        } catch (const std::format_error &) {
+            // 格式说明与记录的类型不匹配时退回默认格式
+            return std::vformat("{}", std::make_format_args(value));
+        }
+    }, arg);
+}
+
+// 解析替换字段 {}、{n}、{:spec}、{n:spec} 以及转义的 {{ 与 }}
+std::string render(std::string_view fmt, const std::vector<Arg> &args) {
+    std::string out;
+    size_t next = 0;
+    for (size_t i = 0; i < fmt.size(); ++i) {
+        char c = fmt[i];
+        if (c == '}' && i + 1 < fmt.size() && fmt[i + 1] == '}') {
+            out += '}';
+            ++i;
+            continue;
+        }
+        if (c != '{') {
+            out += c;
+            continue;
+        }
+        if (i + 1 < fmt.size() && fmt[i + 1] == '{') {
+            out += '{';
+            ++i;
+            continue;
+        }
+        size_t close = fmt.find('}', i);
+        if (close == std::string_view::npos) {
+            out.append(fmt.substr(i));
+            break;
+        }
+        std::string_view field = fmt.substr(i + 1, close - i - 1);
+        std::string_view spec;
+        size_t colon = field.find(':');
+        if (colon != std::string_view::npos) {
+            spec = field.substr(colon + 1);
+            field = field.substr(0, colon);
+        }
+        size_t index = next++;
+        if (!field.empty()) {
+            index = std::stoul(std::string(field));
+        }
+        if (index < args.size()) {
+            out += formatArg(args[index], spec);
+        } else {
+            out.append(fmt.substr(i, close - i + 1));
+        }
+        i = close;
+    }
+    return out;
+}
+
+std::string stamp(int64_t timestampNs) {
+    time_t sec = timestampNs / 1000000000;
+    struct tm t{};
+    localtime_r(&sec, &t);
+    char buf[40];
+    snprintf(buf, sizeof buf, "%d-%02d-%02d %02d:%02d:%02d.%06ld ", t.tm_year + 1900, t.tm_mon + 1, t.tm_mday,
+             t.tm_hour, t.tm_min, t.tm_sec, static_cast<long>(timestampNs % 1000000000 / 1000));
+    return buf;
+}
+
+bool decode(std::istream &in, const std::string &name) {
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    size_t pos = 0;
+    std::vector<Arg> args;
+    while (pos < data.size()) {
+        uint32_t size = 0;
+        if (data.size() - pos >= sizeof size) {
+            memcpy(&size, data.data() + pos, sizeof size);
+        }
+        if (size == 0) {
+            // 进程异常退出时段文件尾部留下的预分配零字节
+            break;
+        }
+        if (size < logrecord::kHeaderSize || size > data.size() - pos) {
+            std::cerr << name << ": truncated record at offset " << pos << std::endl;
+            return false;
+        }
+        Reader reader{data.data() + pos, size, sizeof size};
+        auto level = reader.pod<uint8_t>();
+        auto timestampNs = reader.pod<int64_t>();
+        std::string_view fmt = reader.bytes(reader.pod<uint32_t>());
+        auto argc = reader.pod<uint8_t>();
+        args.clear();
+        for (uint8_t i = 0; i < argc && reader.ok; ++i) {
+            Arg arg;
+            if (!readArg(reader, arg)) {
+                reader.ok = false;
+                break;
+            }
+            args.push_back(std::move(arg));
+        }
+        if (!reader.ok) {
+            std::cerr << name << ": corrupt record at offset " << pos << std::endl;
+            return false;
+        }
+        std::cout << stamp(timestampNs) << levelTitle(level) << render(fmt, args) << '\n';
+        pos += size;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        return decode(std::cin, "<stdin>") ? 0 : 1;
+    }
+    bool ok = true;
+    for (int i = 1; i < argc; ++i) {
+        std::ifstream in(argv[i], std::ios::binary);
+        if (!in) {
+            std::cerr << "cannot open " << argv[i] << std::endl;
+            ok = false;
+            continue;
+        }
+        ok = decode(in, argv[i]) && ok;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+//
+// 二进制日志记录：写入端只拷贝格式串与参数，格式化推迟到离线解码（jsonrpc_logdecode）
+// 布局：[u32 记录总长][u8 级别][i64 墙钟纳秒][u32 格式串长][格式串][u8 参数个数][参数...]
+// 参数：[u8 类型][值]，整数与浮点按本机字节序定长存放，字符串为 [u32 长度][字节]
+//
+
+#ifndef UNTITLED5_LOGRECORD_H
+#define UNTITLED5_LOGRECORD_H
+
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace logrecord {
+
+enum Tag : uint8_t {
+    Int = 0,
+    UInt = 1,
+    Double = 2,
+    String = 3,
+    Bool = 4,
+    Char = 5,
+};
+
+// 记录头：总长、级别、时间戳、格式串长度
+constexpr size_t kHeaderSize = 4 + 1 + 8 + 4;
+
+template<class T>
+void putPod(std::string &out, T value) {
+    out.append(reinterpret_cast<const char *>(&value), sizeof value);
+}
+
+inline void putString(std::string &out, std::string_view value) {
+    putPod<uint8_t>(out, String);
+    putPod<uint32_t>(out, static_cast<uint32_t>(value.size()));
+    out.append(value.data(), value.size());
+}
+
+template<class T>
+void putArg(std::string &out, const T &value) {
+    using D = std::decay_t<T>;
+    if constexpr (std::is_same_v<D, bool>) {
+        putPod<uint8_t>(out, Bool);
+        putPod<uint8_t>(out, value ? 1 : 0);
+    } else if constexpr (std::is_same_v<D, char>) {
+        putPod<uint8_t>(out, Char);
+        putPod<char>(out, value);
+    } else if constexpr (std::is_integral_v<D> && std::is_signed_v<D>) {
+        putPod<uint8_t>(out, Int);
+        putPod<int64_t>(out, value);
+    } else if constexpr (std::is_integral_v<D>) {
+        putPod<uint8_t>(out, UInt);
+        putPod<uint64_t>(out, value);
+    } else if constexpr (std::is_floating_point_v<D>) {
+        putPod<uint8_t>(out, Double);
+        putPod<double>(out, value);
+    } else if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+        putString(out, std::string_view(value));
+    } else {
+        // 其余类型（指针、自定义 formatter）在写入端先格式化成字符串
+        putString(out, std::format("{}", value));
+    }
+}
+
+template<class... Args>
+void encode(std::string &out, int level, int64_t timestampNs, std::string_view fmt, const Args &...args) {
+    size_t begin = out.size();
+    putPod<uint32_t>(out, 0);
+    putPod<uint8_t>(out, static_cast<uint8_t>(level));
+    putPod<int64_t>(out, timestampNs);
+    putPod<uint32_t>(out, static_cast<uint32_t>(fmt.size()));
+    out.append(fmt.data(), fmt.size());
+    putPod<uint8_t>(out, static_cast<uint8_t>(sizeof...(Args)));
+    (putArg(out, args), ...);
+    auto size = static_cast<uint32_t>(out.size() - begin);
+    memcpy(out.data() + begin, &size, sizeof size);
+}
+
+} // namespace logrecord
+
+#endif //UNTITLED5_LOGRECORD_H
@@ -0,0 +1,381 @@
+//
+// 有界无锁多生产者多消费者队列：容量为 2 的幂的环形数组，每个槽位带序号，入队与出队各自只竞争一次 CAS。
+// 阻塞版本先自旋重试，仍不成功才在条件变量上睡眠；只有存在睡眠者时另一端才去加锁通知
+//
+
+#ifndef UNTITLED5_MPMCQUEUE_H
+#define UNTITLED5_MPMCQUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+template<class T>
+class MpmcQueue {
+public:
+    // 容量向上取整到 2 的幂
+    explicit MpmcQueue(size_t capacity);
+
+    ~MpmcQueue();
+
+    MpmcQueue(const MpmcQueue &) = delete;
+
+    MpmcQueue &operator=(const MpmcQueue &) = delete;
+
+    // 队列满或已关闭时返回 false，item 保持不变
+    bool tryPush(T &&item);
+
+    // 队列满时等待；已关闭时返回 false
+    bool push(T &&item);
+
+    // 从 items 中依次移出元素入队，返回入队个数；tryPushN 只放入当前能放下的部分
+    size_t tryPushN(T *items, size_t count);
+
+    size_t pushN(T *items, size_t count);
+
+    bool tryPop(T &item);
+
+    // 队列空时等待；关闭后先取完剩余元素，再返回 false
+    bool pop(T &item);
+
+    template<class Rep, class Period>
+    bool pop(T &item, std::chrono::duration<Rep, Period> timeout);
+
+    // 取出至多 max 个元素追加到 out，返回个数；popN 至少等到一个元素或队列关闭且为空
+    size_t tryPopN(std::vector<T> &out, size_t max);
+
+    size_t popN(std::vector<T> &out, size_t max);
+
+    template<class Rep, class Period>
+    size_t popN(std::vector<T> &out, size_t max, std::chrono::duration<Rep, Period> timeout);
+
+    // 唤醒所有等待者，之后入队失败
+    void close();
+
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+    // 并发修改时只是近似值
+    size_t size() const;
+
+    bool empty() const { return size() == 0; }
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<size_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T *value() { return std::launder(reinterpret_cast<T *>(storage)); }
+    };
+
+    static constexpr int SPIN_LIMIT = 64;
+
+    // 队列两端都用 seq_cst 发布与检查：要么睡眠者的重试看到新状态，要么另一端看到睡眠者并通知
+    size_t claimPush_(size_t max, size_t &pos);
+
+    size_t claimPop_(size_t max, size_t &pos);
+
+    void wakeConsumers_(size_t count);
+
+    void wakeProducers_(size_t count);
+
+    static void relax_(int spin);
+
+    template<class Try>
+    bool spin_(Try &&attempt);
+
+    // 自旋不成功后登记为等待者，重试失败时睡到另一端推进 epoch、队列关闭或超时
+    template<class Try>
+    bool wait_(Try &&attempt, std::atomic<int> &waiting, uint64_t &epoch, std::condition_variable &cond,
+               std::chrono::steady_clock::time_point deadline);
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> tail_{0};
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<int> consumersWaiting_{0};
+    std::atomic<int> producersWaiting_{0};
+    std::atomic<bool> closed_{false};
+    std::mutex parkMtx_;
+    // 由 parkMtx_ 保护，每次通知前递增，避免睡眠前错过通知
+    uint64_t pushEpoch_ = 0;
+    uint64_t popEpoch_ = 0;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+};
+
+template<class T>
+MpmcQueue<T>::MpmcQueue(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) size <<= 1;
+    slots_ = std::make_unique<Slot[]>(size);
+    mask_ = size - 1;
+    for (size_t i = 0; i < size; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template<class T>
+MpmcQueue<T>::~MpmcQueue() {
+    size_t head = head_.load(std::memory_order_relaxed);
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    for (size_t pos = head; pos != tail; ++pos) {
+        slots_[pos & mask_].value()->~T();
+    }
+}
+
+template<class T>
+size_t MpmcQueue<T>::claimPush_(size_t max, size_t &pos) {
+    pos = tail_.load(std::memory_order_relaxed);
+    while (true) {
+        // 从 pos 起连续的空闲槽位，抢到后这些槽位只属于当前线程
+        size_t count = 0;
+        while (count < max) {
+            size_t sequence = slots_[(pos + count) & mask_].sequence.load(std::memory_order_seq_cst);
+            if (sequence != pos + count) break;
+            ++count;
+        }
+        if (count == 0) {
+            auto diff = static_cast<intptr_t>(slots_[pos & mask_].sequence.load(std::memory_order_seq_cst)) -
+                        static_cast<intptr_t>(pos);
+            // 消费者还没取走上一轮的元素
+            if (diff < 0) return 0;
+            pos = tail_.load(std::memory_order_relaxed);
+            continue;
+        }
+        if (tail_.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+            return count;
+        }
+    }
+}
+
+template<class T>
+size_t MpmcQueue<T>::claimPop_(size_t max, size_t &pos) {
+    pos = head_.load(std::memory_order_relaxed);
+    while (true) {
+        size_t count = 0;
+        while (count < max) {
+            size_t sequence = slots_[(pos + count) & mask_].sequence.load(std::memory_order_seq_cst);
+            if (sequence != pos + count + 1) break;
+            ++count;
+        }
+        if (count == 0) {
+            auto diff = static_cast<intptr_t>(slots_[pos & mask_].sequence.load(std::memory_order_seq_cst)) -
+                        static_cast<intptr_t>(pos + 1);
+            // 生产者还没写完这个位置
+            if (diff < 0) return 0;
+            pos = head_.load(std::memory_order_relaxed);
+            continue;
+        }
+        if (head_.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+            return count;
+        }
+    }
+}
+
+template<class T>
+bool MpmcQueue<T>::tryPush(T &&item) {
+    return tryPushN(&item, 1) == 1;
+}
+
+template<class T>
+size_t MpmcQueue<T>::tryPushN(T *items, size_t count) {
+    if (count == 0 || closed_.load(std::memory_order_acquire)) return 0;
+    size_t pos;
+    size_t claimed = claimPush_(count, pos);
+    for (size_t i = 0; i < claimed; ++i) {
+        Slot &slot = slots_[(pos + i) & mask_];
+        new(slot.storage) T(std::move(items[i]));
+        slot.sequence.store(pos + i + 1, std::memory_order_seq_cst);
+    }
+    if (claimed > 0) wakeConsumers_(claimed);
+    return claimed;
+}
+
+template<class T>
+bool MpmcQueue<T>::tryPop(T &item) {
+    size_t pos;
+    if (claimPop_(1, pos) == 0) return false;
+    Slot &slot = slots_[pos & mask_];
+    item = std::move(*slot.value());
+    slot.value()->~T();
+    // 下一轮的 pos 为当前 pos + 容量
+    slot.sequence.store(pos + mask_ + 1, std::memory_order_seq_cst);
+    wakeProducers_(1);
+    return true;
+}
+
+template<class T>
+size_t MpmcQueue<T>::tryPopN(std::vector<T> &out, size_t max) {
+    if (max == 0) return 0;
+    size_t pos;
+    size_t claimed = claimPop_(max, pos);
+    for (size_t i = 0; i < claimed; ++i) {
+        Slot &slot = slots_[(pos + i) & mask_];
+        out.push_back(std::move(*slot.value()));
+        slot.value()->~T();
+        slot.sequence.store(pos + i + mask_ + 1, std::memory_order_seq_cst);
+    }
+    if (claimed > 0) wakeProducers_(claimed);
+    return claimed;
+}
+
+template<class T>
+void MpmcQueue<T>::wakeConsumers_(size_t count) {
+    if (consumersWaiting_.load(std::memory_order_seq_cst) == 0) return;
+    std::lock_guard<std::mutex> lockGuard(parkMtx_);
+    ++pushEpoch_;
+    if (count == 1) {
+        notEmpty_.notify_one();
+    } else {
+        notEmpty_.notify_all();
+    }
+}
+
+template<class T>
+void MpmcQueue<T>::wakeProducers_(size_t count) {
+    if (producersWaiting_.load(std::memory_order_seq_cst) == 0) return;
+    std::lock_guard<std::mutex> lockGuard(parkMtx_);
+    ++popEpoch_;
+    if (count == 1) {
+        notFull_.notify_one();
+    } else {
+        notFull_.notify_all();
+    }
+}
+
+template<class T>
+void MpmcQueue<T>::relax_(int spin) {
+    // 前几次只做处理器级别的暂停，之后让出时间片
+    if (spin < SPIN_LIMIT / 2) {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    } else {
+        std::this_thread::yield();
+    }
+}
+
+template<class T>
+template<class Try>
+bool MpmcQueue<T>::spin_(Try &&attempt) {
+    for (int spin = 0; spin < SPIN_LIMIT; ++spin) {
+        if (attempt()) return true;
+        if (closed_.load(std::memory_order_acquire)) return false;
+        relax_(spin);
+    }
+    return false;
+}
+
+template<class T>
+template<class Try>
+bool MpmcQueue<T>::wait_(Try &&attempt, std::atomic<int> &waiting, uint64_t &epoch, std::condition_variable &cond,
+                         std::chrono::steady_clock::time_point deadline) {
+    if (spin_(attempt)) return true;
+    waiting.fetch_add(1, std::memory_order_seq_cst);
+    bool done = false;
+    while (true) {
+        uint64_t seen;
+        {
+            std::lock_guard<std::mutex> lockGuard(parkMtx_);
+            seen = epoch;
+        }
+        // 重试不持锁：成功时会去通知另一端，而通知需要 parkMtx_
+        if ((done = attempt())) break;
+        std::unique_lock<std::mutex> lock(parkMtx_);
+        bool woken = closed_.load(std::memory_order_acquire) ||
+                     cond.wait_until(lock, deadline, [this, &epoch, seen] {
+                         return epoch != seen || closed_.load(std::memory_order_acquire);
+                     });
+        if (!woken || closed_.load(std::memory_order_acquire)) {
+            // 超时或关闭后再试一次，关闭前入队的元素仍能取出
+            lock.unlock();
+            done = attempt();
+            break;
+        }
+    }
+    waiting.fetch_sub(1, std::memory_order_relaxed);
+    return done;
+}
+
+template<class T>
+bool MpmcQueue<T>::push(T &&item) {
+    return wait_([this, &item] { return tryPush(std::move(item)); }, producersWaiting_, popEpoch_, notFull_,
+                 std::chrono::steady_clock::time_point::max());
+}
+
+template<class T>
+size_t MpmcQueue<T>::pushN(T *items, size_t count) {
+    size_t done = 0;
+    while (done < count) {
+        size_t n = tryPushN(items + done, count - done);
+        if (n > 0) {
+            done += n;
+            continue;
+        }
+        // 放不下时逐个阻塞入队，腾出空间后再回到批量
+        if (!push(std::move(items[done]))) break;
+        ++done;
+    }
+    return done;
+}
+
+template<class T>
+bool MpmcQueue<T>::pop(T &item) {
+    return wait_([this, &item] { return tryPop(item); }, consumersWaiting_, pushEpoch_, notEmpty_,
+                 std::chrono::steady_clock::time_point::max());
+}
+
+template<class T>
+template<class Rep, class Period>
+bool MpmcQueue<T>::pop(T &item, std::chrono::duration<Rep, Period> timeout) {
+    return wait_([this, &item] { return tryPop(item); }, consumersWaiting_, pushEpoch_, notEmpty_,
+                 std::chrono::steady_clock::now() + timeout);
+}
+
+template<class T>
+size_t MpmcQueue<T>::popN(std::vector<T> &out, size_t max) {
+    size_t count = 0;
+    wait_([this, &out, max, &count] { return (count = tryPopN(out, max)) > 0; }, consumersWaiting_, pushEpoch_,
+          notEmpty_, std::chrono::steady_clock::time_point::max());
+    return count;
+}
+
+template<class T>
+template<class Rep, class Period>
+size_t MpmcQueue<T>::popN(std::vector<T> &out, size_t max, std::chrono::duration<Rep, Period> timeout) {
+    size_t count = 0;
+    wait_([this, &out, max, &count] { return (count = tryPopN(out, max)) > 0; }, consumersWaiting_, pushEpoch_,
+          notEmpty_, std::chrono::steady_clock::now() + timeout);
+    return count;
+}
+
+template<class T>
+void MpmcQueue<T>::close() {
+    {
+        std::lock_guard<std::mutex> lockGuard(parkMtx_);
+        closed_.store(true, std::memory_order_release);
+    }
+    notEmpty_.notify_all();
+    notFull_.notify_all();
+}
+
+template<class T>
+size_t MpmcQueue<T>::size() const {
+    size_t head = head_.load(std::memory_order_acquire);
+    size_t tail = tail_.load(std::memory_order_acquire);
+    return tail > head ? tail - head : 0;
+}
+
+#endif //UNTITLED5_MPMCQUEUE_H
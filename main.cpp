@@ -23,7 +23,7 @@ int main() {
     std::string errs;       // 用于存储解析错误
 
 
-    std::string responseAdd = server.handleRequest(requestAdd);
+    std::string responseAdd = server.process(requestAdd);
     // 将 JSON 字符串转换为输入流
     std::istringstream s(responseAdd);
     Json::parseFromStream(readerBuilder, s, &jsonData, &errs);
@@ -33,7 +33,7 @@ int main() {
     s.clear();
 
 
-    std::string responseConcat = server.handleRequest(requestConcat);
+    std::string responseConcat = server.process(requestConcat);
     s.str(responseConcat);
     Json::parseFromStream(readerBuilder, s, &jsonData, &errs);
     std::cout << "Response: " << responseConcat << std::endl;
@@ -43,7 +43,7 @@ int main() {
     JsonRpcClient client;
     string request=client.sendRequest("concat", value);
     cout<<request<<endl;
-    responseAdd = server.handleRequest(request);
+    responseAdd = server.process(request);
     cout << responseAdd;
     return 0;
 }
@@ -0,0 +1,153 @@
+//
+// 准入控制：全局与方法级并发上限、异步执行器排队满时的拒绝，以及运行中调整上限
+//
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "JsonRpcServer.h"
+#include "test_util.h"
+
+namespace {
+
+// 调用方在 open() 之前一直阻塞在方法内，用来占住并发名额
+struct Gate {
+    std::mutex mtx;
+    std::condition_variable cond;
+    bool opened = false;
+    std::atomic<int> entered{0};
+
+    int pass(int value) {
+        entered.fetch_add(1);
+        std::unique_lock<std::mutex> lock(mtx);
+        cond.wait(lock, [this] { return opened; });
+        return value;
+    }
+
+    void open() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            opened = true;
+        }
+        cond.notify_all();
+    }
+
+    void waitEntered(int count) {
+        while (entered.load() < count) std::this_thread::yield();
+    }
+};
+
+int add(int a, int b) { return a + b; }
+
+const std::string kBlock = R"({"jsonrpc": "2.0", "method": "block", "params": [1], "id": 1})";
+const std::string kAdd = R"({"jsonrpc": "2.0", "method": "add", "params": [1, 2], "id": 2})";
+
+} // namespace
+
+TEST(AdmissionTest, InFlightLimitRejectsExcess) {
+    JsonRpcServer server;
+    Gate gate;
+    server.registerMethod("block", [&gate](int value) { return gate.pass(value); });
+    server.registerMethod("add", add);
+    server.setAdmissionLimits(1, 0);
+
+    auto blocked = std::async(std::launch::async, [&] { return processJson(server, kBlock); });
+    gate.waitEntered(1);
+    Json::Value rejected = processJson(server, kAdd);
+    EXPECT_EQ(rejected["error"]["code"].asInt(), -32002);
+    EXPECT_EQ(server.metrics("add")["methods"]["add"]["errors"]["-32002"].asUInt64(), 1u);
+
+    gate.open();
+    EXPECT_EQ(blocked.get()["result"].asInt(), 1);
+    // 名额在结果产生后归还
+    EXPECT_EQ(processJson(server, kAdd)["result"].asInt(), 3);
+    EXPECT_EQ(server.metrics()["inFlight"].asUInt64(), 0u);
+}
+
+TEST(AdmissionTest, MethodConcurrencyLimitIsPerMethod) {
+    JsonRpcServer server;
+    Gate gate;
+    server.registerMethod("block", [&gate](int value) { return gate.pass(value); });
+    server.registerMethod("add", add);
+    server.setMethodConcurrency("block", 1);
+    EXPECT_THROW(server.setMethodConcurrency("missing", 1), std::runtime_error);
+
+    auto blocked = std::async(std::launch::async, [&] { return processJson(server, kBlock); });
+    gate.waitEntered(1);
+    EXPECT_EQ(processJson(server, kBlock)["error"]["code"].asInt(), -32002);
+    // 其他方法不受影响
+    EXPECT_EQ(processJson(server, kAdd)["result"].asInt(), 3);
+
+    gate.open();
+    EXPECT_EQ(blocked.get()["result"].asInt(), 1);
+}
+
+TEST(AdmissionTest, MethodLimitSurvivesOverwrite) {
+    JsonRpcServer server;
+    Gate gate;
+    server.registerMethod("block", [&gate](int value) { return gate.pass(value); });
+    server.setMethodConcurrency("block", 1);
+    server.registerMethod("block", [&gate](int value) { return gate.pass(value + 1); }, true);
+
+    auto blocked = std::async(std::launch::async, [&] { return processJson(server, kBlock); });
+    gate.waitEntered(1);
+    EXPECT_EQ(processJson(server, kBlock)["error"]["code"].asInt(), -32002);
+    gate.open();
+    EXPECT_EQ(blocked.get()["result"].asInt(), 2);
+}
+
+TEST(AdmissionTest, AsyncRejectedWhenExecutorQueueIsFull) {
+    JsonRpcServer server;
+    Gate gate;
+    server.registerMethod("block", [&gate](int value) { return gate.pass(value); });
+    server.setAsyncExecutor(1, 1);
+
+    auto asyncRequest = [](int id) {
+        return R"({"jsonrpc": "2.0", "method": "block", "params": [)" + std::to_string(id) + R"(], "id": )" +
+               std::to_string(id) + R"(, "async": true, "client": "c"})";
+    };
+    EXPECT_EQ(processJson(server, asyncRequest(1))["result"].asString(), "Task accepted");
+    // 唯一的执行线程被占住，第二个请求排队，第三个超过排队上限
+    gate.waitEntered(1);
+    EXPECT_EQ(processJson(server, asyncRequest(2))["result"].asString(), "Task accepted");
+    Json::Value busy = processJson(server, asyncRequest(3));
+    EXPECT_EQ(busy["error"]["code"].asInt(), -32002);
+    EXPECT_EQ(busy["id"].asInt(), 3);
+    EXPECT_EQ(server.executorStats().rejected, 1u);
+
+    gate.open();
+    EXPECT_EQ(pollAsyncResult(server, "c", 1)["result"].asInt(), 1);
+    EXPECT_EQ(pollAsyncResult(server, "c", 2)["result"].asInt(), 2);
+}
+
+TEST(AdmissionTest, LimitsCanChangeWhileServing) {
+    JsonRpcServer server;
+    server.registerMethod("add", add);
+    std::atomic<bool> stop{false};
+    std::thread tuner([&] {
+        for (size_t i = 0; !stop; ++i) {
+            server.setAdmissionLimits(i % 2 == 0 ? 0 : 64, 0);
+        }
+    });
+    std::vector<std::thread> callers;
+    std::atomic<int> answered{0};
+    for (int t = 0; t < 4; ++t) {
+        callers.emplace_back([&] {
+            for (int i = 0; i < 500; ++i) {
+                Json::Value response = processJson(server, kAdd);
+                if (response["result"].asInt() == 3 || response["error"]["code"].asInt() == -32002) ++answered;
+            }
+        });
+    }
+    for (auto &caller: callers) caller.join();
+    stop = true;
+    tuner.join();
+    EXPECT_EQ(answered.load(), 2000);
+}
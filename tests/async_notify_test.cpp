@@ -0,0 +1,83 @@
+//
+// 推送模式的异步请求：推送丢失时结果仍可经 getAsyncResult 取回，"ack" 确认后删除，参数错误报 -32602
+//
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include "Coroutine.h"
+#include "JsonRpcServer.h"
+#include "test_util.h"
+
+namespace {
+
+using namespace std::chrono_literals;
+
+Task<int> slowDouble(int value) {
+    co_await EventLoop::current()->sleepFor(2ms);
+    if (value < 0) throw std::invalid_argument("negative");
+    co_return value * 2;
+}
+
+std::string pushRequest(const std::string &method, const std::string &params, int id,
+                        const std::string &extra = "") {
+    return R"({"jsonrpc": "2.0", "method": ")" + method + R"(", "params": )" + params + R"(, "id": )" +
+           std::to_string(id) + R"(, "async": true, "notify": true, "client": "c1")" + extra + "}";
+}
+
+class AsyncNotifyTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        server.registerMethod("add", [](int a, int b) { return a + b; });
+        server.registerMethod("slowDouble", slowDouble);
+        // 测试环境中没有订阅者，推送全部丢失
+        server.enableAsyncNotify(0);
+    }
+
+    JsonRpcServer server;
+};
+
+} // namespace
+
+TEST_F(AsyncNotifyTest, PushedResultStaysPollable) {
+    Json::Value accepted = processJson(server, pushRequest("add", "[2, 3]", 1));
+    EXPECT_EQ(accepted["result"], "Task accepted");
+    EXPECT_TRUE(accepted["notify"].asBool());
+    EXPECT_EQ(pollAsyncResult(server, "c1", 1)["result"].asInt(), 5);
+    // 取走之后不再保留
+    EXPECT_EQ(pollAsyncResult(server, "c1", 1)["error"]["code"].asInt(), -32602);
+}
+
+TEST_F(AsyncNotifyTest, CoroutineResultStaysPollable) {
+    EXPECT_TRUE(processJson(server, pushRequest("slowDouble", "[21]", 2))["notify"].asBool());
+    EXPECT_EQ(pollAsyncResult(server, "c1", 2)["result"].asInt(), 42);
+}
+
+TEST_F(AsyncNotifyTest, AckDiscardsPollableCopy) {
+    processJson(server, pushRequest("add", "[1, 1]", 3));
+    processJson(server, pushRequest("add", "[2, 2]", 4));
+    // 任意后续请求都可以捎带确认
+    processJson(server, pushRequest("add", "[3, 3]", 5, R"(, "ack": [3, 4, 99])"));
+    EXPECT_EQ(pollAsyncResult(server, "c1", 3)["error"]["code"].asInt(), -32602);
+    EXPECT_EQ(pollAsyncResult(server, "c1", 4)["error"]["code"].asInt(), -32602);
+    EXPECT_EQ(pollAsyncResult(server, "c1", 5)["result"].asInt(), 6);
+    EXPECT_EQ(server.asyncResultStats().size, 0u);
+}
+
+TEST_F(AsyncNotifyTest, AckFromAnotherClientIsIgnored) {
+    processJson(server, pushRequest("add", "[1, 2]", 6));
+    processJson(server, R"({"jsonrpc": "2.0", "method": "add", "params": [0, 0], "id": 7, "client": "c2",)"
+                        R"( "ack": [6]})");
+    EXPECT_EQ(pollAsyncResult(server, "c1", 6)["result"].asInt(), 3);
+}
+
+TEST_F(AsyncNotifyTest, InvalidParamsReportedAsInvalidParams) {
+    processJson(server, pushRequest("add", R"(["x", "y"])", 8));
+    Json::Value response = pollAsyncResult(server, "c1", 8);
+    EXPECT_EQ(response["error"]["code"].asInt(), -32602);
+    processJson(server, pushRequest("slowDouble", "[-1]", 9));
+    EXPECT_EQ(pollAsyncResult(server, "c1", 9)["error"]["code"].asInt(), -32602);
+    EXPECT_EQ(server.metrics("add")["methods"]["add"]["errors"]["-32602"].asUInt64(), 1u);
+}
@@ -0,0 +1,156 @@
+//
+// AsyncResultStore：按 (客户端, id) 存取、TTL 过期、容量淘汰与并发存取
+//
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AsyncResultStore.h"
+
+namespace {
+
+std::future<Json::Value> readyValue(const Json::Value &value) {
+    std::promise<Json::Value> promise;
+    promise.set_value(value);
+    return promise.get_future();
+}
+
+} // namespace
+
+TEST(AsyncResultStoreTest, PendingThenReadyThenGone) {
+    AsyncResultStore store;
+    std::promise<Json::Value> promise;
+    store.put("client", 1, promise.get_future());
+
+    std::future<Json::Value> out;
+    EXPECT_EQ(store.take("client", 1, out), AsyncResultStore::Status::Pending);
+    promise.set_value(42);
+    ASSERT_EQ(store.take("client", 1, out), AsyncResultStore::Status::Ready);
+    EXPECT_EQ(out.get().asInt(), 42);
+    EXPECT_EQ(store.take("client", 1, out), AsyncResultStore::Status::NotFound);
+    EXPECT_EQ(store.stats().size, 0u);
+}
+
+TEST(AsyncResultStoreTest, SameIdFromDifferentClientsIsIsolated) {
+    AsyncResultStore store;
+    store.put("a", 7, readyValue("from a"));
+    store.put("b", 7, readyValue("from b"));
+
+    std::future<Json::Value> out;
+    ASSERT_EQ(store.take("b", 7, out), AsyncResultStore::Status::Ready);
+    EXPECT_EQ(out.get().asString(), "from b");
+    ASSERT_EQ(store.take("a", 7, out), AsyncResultStore::Status::Ready);
+    EXPECT_EQ(out.get().asString(), "from a");
+    EXPECT_EQ(store.take("c", 7, out), AsyncResultStore::Status::NotFound);
+}
+
+TEST(AsyncResultStoreTest, ExpiresAfterTtl) {
+    AsyncResultStore store(std::chrono::milliseconds(20));
+    store.put("client", 1, readyValue(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+
+    std::future<Json::Value> out;
+    EXPECT_EQ(store.take("client", 1, out), AsyncResultStore::Status::NotFound);
+    EXPECT_EQ(store.stats().expired, 1u);
+    EXPECT_EQ(store.stats().size, 0u);
+}
+
+TEST(AsyncResultStoreTest, EvictsOldestWhenFull) {
+    AsyncResultStore store(std::chrono::minutes(5), 16);
+    for (int id = 0; id < 200; ++id) {
+        store.put("client", id, readyValue(id));
+    }
+    auto stats = store.stats();
+    EXPECT_EQ(stats.size, 16u);
+    EXPECT_EQ(stats.evicted, 184u);
+
+    // 上限对全表生效，按写入顺序淘汰，与键落在哪个分片无关
+    std::future<Json::Value> out;
+    EXPECT_EQ(store.take("client", 183, out), AsyncResultStore::Status::NotFound);
+    for (int id = 184; id < 200; ++id) {
+        ASSERT_EQ(store.take("client", id, out), AsyncResultStore::Status::Ready) << id;
+        EXPECT_EQ(out.get().asInt(), id);
+    }
+}
+
+TEST(AsyncResultStoreTest, CapacityIsNotRoundedToShardCount) {
+    AsyncResultStore store(std::chrono::minutes(5), 10);
+    for (int id = 0; id < 40; ++id) {
+        store.put("client-" + std::to_string(id % 3), id, readyValue(id));
+    }
+    EXPECT_EQ(store.stats().size, 10u);
+    EXPECT_EQ(store.stats().evicted, 30u);
+}
+
+TEST(AsyncResultStoreTest, StatsPurgesIdleShards) {
+    AsyncResultStore store(std::chrono::milliseconds(20));
+    for (int id = 0; id < 64; ++id) {
+        store.put("client", id, readyValue(id));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    // 之后没有任何写入，过期结果仍会被清除并计数
+    auto stats = store.stats();
+    EXPECT_EQ(stats.size, 0u);
+    EXPECT_EQ(stats.expired, 64u);
+}
+
+TEST(AsyncResultStoreTest, OverwriteDoesNotEvict) {
+    AsyncResultStore store(std::chrono::minutes(5), 16);
+    for (int i = 0; i < 10; ++i) {
+        store.put("client", 1, readyValue(i));
+    }
+    EXPECT_EQ(store.stats().size, 1u);
+    EXPECT_EQ(store.stats().evicted, 0u);
+
+    std::future<Json::Value> out;
+    ASSERT_EQ(store.take("client", 1, out), AsyncResultStore::Status::Ready);
+    EXPECT_EQ(out.get().asInt(), 9);
+}
+
+TEST(AsyncResultStoreTest, ConcurrentPutAndTake) {
+    constexpr int kThreads = 8;
+    constexpr int kIds = 2000;
+    AsyncResultStore store;
+    std::vector<std::thread> threads;
+    std::vector<int> taken(kThreads, 0);
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&store, &taken, t] {
+            std::string client = "client-" + std::to_string(t);
+            for (int id = 0; id < kIds; ++id) {
+                store.put(client, id, readyValue(id + t));
+            }
+            for (int id = 0; id < kIds; ++id) {
+                std::future<Json::Value> out;
+                if (store.take(client, id, out) == AsyncResultStore::Status::Ready && out.get().asInt() == id + t) {
+                    ++taken[t];
+                }
+            }
+        });
+    }
+    for (auto &thread: threads) thread.join();
+    for (int t = 0; t < kThreads; ++t) EXPECT_EQ(taken[t], kIds);
+    EXPECT_EQ(store.stats().size, 0u);
+    EXPECT_EQ(store.stats().evicted, 0u);
+}
+
+TEST(AsyncResultStoreTest, ConcurrentPutsStayNearBound) {
+    constexpr int kThreads = 8;
+    constexpr int kIds = 5000;
+    constexpr size_t kMaxSize = 100;
+    AsyncResultStore store(std::chrono::minutes(5), kMaxSize);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&store, t] {
+            for (int id = 0; id < kIds; ++id) {
+                store.put("client-" + std::to_string(t), id, readyValue(id));
+            }
+        });
+    }
+    for (auto &thread: threads) thread.join();
+    auto stats = store.stats();
+    EXPECT_EQ(stats.size, kMaxSize);
+    EXPECT_EQ(stats.size + stats.evicted, static_cast<uint64_t>(kThreads * kIds));
+}
@@ -0,0 +1,99 @@
+//
+// 客户端连接池：端点都没有服务器应答时的超时处理。非幂等请求只尝试一次，幂等请求换端点重试，
+// 连续失败的端点被摘除且恢复后按慢端点对待，轮转策略在端点间平均分配
+//
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "JsonRpcClientPool.h"
+
+namespace {
+
+using namespace std::chrono_literals;
+
+// 本机上没有服务在监听的端口，请求只会超时
+constexpr int kDeadPortA = 1;
+constexpr int kDeadPortB = 2;
+
+std::string callError(JsonRpcClientPool &pool, bool idempotent) {
+    try {
+        pool.call("add", Json::Value(Json::arrayValue), idempotent);
+    } catch (const std::runtime_error &e) {
+        return e.what();
+    }
+    return "";
+}
+
+} // namespace
+
+TEST(ClientPoolTest, NoEndpoints) {
+    JsonRpcClientPool pool;
+    EXPECT_EQ(callError(pool, true), "No endpoints");
+}
+
+TEST(ClientPoolTest, NonIdempotentTimeoutIsNotRetried) {
+    JsonRpcClientPool pool;
+    pool.addEndpoint("127.0.0.1", kDeadPortA);
+    pool.addEndpoint("127.0.0.1", kDeadPortB);
+    pool.setTimeout(20ms);
+    pool.setRetry(3);
+    EXPECT_EQ(callError(pool, false), "Request to 127.0.0.1:1 timed out");
+    std::vector<JsonRpcClientPool::EndpointStats> stats = pool.stats();
+    EXPECT_EQ(stats[0].requests + stats[1].requests, 1u);
+    EXPECT_EQ(stats[0].failures, 1u);
+    EXPECT_EQ(stats[0].outstanding, 0u);
+}
+
+TEST(ClientPoolTest, IdempotentRetryMovesToAnotherEndpoint) {
+    JsonRpcClientPool pool;
+    pool.addEndpoint("127.0.0.1", kDeadPortA);
+    pool.addEndpoint("127.0.0.1", kDeadPortB);
+    pool.setTimeout(20ms);
+    pool.setRetry(2);
+    EXPECT_EQ(callError(pool, true), "Request timed out");
+    for (const auto &endpoint: pool.stats()) {
+        EXPECT_EQ(endpoint.requests, 1u) << endpoint.endpoint;
+        EXPECT_EQ(endpoint.failures, 1u) << endpoint.endpoint;
+    }
+}
+
+TEST(ClientPoolTest, FailingEndpointIsEjectedAndMarkedSlow) {
+    JsonRpcClientPool pool(LoadBalancing::Ewma);
+    pool.addEndpoint("127.0.0.1", kDeadPortA);
+    pool.addEndpoint("127.0.0.1", kDeadPortB);
+    pool.setTimeout(20ms);
+    pool.setRetry(1);
+    pool.setEjection(1, std::chrono::hours(1));
+    callError(pool, false);
+    std::vector<JsonRpcClientPool::EndpointStats> stats = pool.stats();
+    ASSERT_TRUE(stats[0].ejected);
+    EXPECT_EQ(stats[0].ewmaMicros, 20000);
+    // 被摘除的端点不再被选中，直到所有端点都被摘除
+    callError(pool, false);
+    stats = pool.stats();
+    EXPECT_EQ(stats[0].requests, 1u);
+    EXPECT_EQ(stats[1].requests, 1u);
+    EXPECT_TRUE(stats[1].ejected);
+    callError(pool, false);
+    stats = pool.stats();
+    EXPECT_EQ(stats[0].requests + stats[1].requests, 3u);
+}
+
+TEST(ClientPoolTest, RoundRobinSpreadsRequests) {
+    JsonRpcClientPool pool(LoadBalancing::RoundRobin);
+    pool.addEndpoint("127.0.0.1", kDeadPortA);
+    pool.addEndpoint("127.0.0.1", kDeadPortB);
+    pool.setTimeout(5ms);
+    pool.setRetry(1);
+    pool.setEjection(100, 1ms);
+    for (int i = 0; i < 6; ++i) {
+        callError(pool, false);
+    }
+    for (const auto &endpoint: pool.stats()) {
+        EXPECT_EQ(endpoint.requests, 3u) << endpoint.endpoint;
+        EXPECT_FALSE(endpoint.ejected);
+    }
+}
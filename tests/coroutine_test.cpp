@@ -0,0 +1,164 @@
+//
+// EventLoop 与协程方法：结果与异常的传递、定时器顺序、跨线程回调，以及经 process() 的同步、异步与分离回复
+//
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Coroutine.h"
+#include "JsonRpcServer.h"
+#include "test_util.h"
+
+namespace {
+
+using namespace std::chrono_literals;
+
+Task<int> delayedValue(EventLoop &loop, int value, std::chrono::milliseconds delay) {
+    co_await loop.sleepFor(delay);
+    co_return value;
+}
+
+Task<int> failing(EventLoop &loop) {
+    co_await loop.schedule();
+    throw std::runtime_error("boom");
+}
+
+Task<int> slowAdd(int a, int b) {
+    co_await EventLoop::current()->sleepFor(5ms);
+    co_return a + b;
+}
+
+} // namespace
+
+TEST(EventLoopTest, SpawnDeliversResultOnLoopThread) {
+    EventLoop loop;
+    std::promise<std::pair<int, bool>> done;
+    loop.spawn(delayedValue(loop, 42, 5ms), [&loop, &done](std::exception_ptr error, std::optional<int> value) {
+        done.set_value({error ? -1 : *value, EventLoop::current() == &loop});
+    });
+    auto [value, onLoop] = done.get_future().get();
+    EXPECT_EQ(value, 42);
+    EXPECT_TRUE(onLoop);
+}
+
+TEST(EventLoopTest, SpawnDeliversException) {
+    EventLoop loop;
+    std::promise<std::string> done;
+    loop.spawn(failing(loop), [&done](std::exception_ptr error, std::optional<int> value) {
+        try {
+            if (error) std::rethrow_exception(error);
+            done.set_value("no error, value " + std::to_string(*value));
+        } catch (const std::runtime_error &e) {
+            done.set_value(e.what());
+        }
+    });
+    EXPECT_EQ(done.get_future().get(), "boom");
+}
+
+TEST(EventLoopTest, TimersFireInDeadlineOrder) {
+    EventLoop loop;
+    // 完成回调都在循环线程上执行，order 无需加锁
+    std::vector<int> order;
+    std::promise<void> finished;
+    int remaining = 3;
+    auto done = [&](std::exception_ptr, std::optional<int> value) {
+        order.push_back(*value);
+        if (--remaining == 0) finished.set_value();
+    };
+    loop.spawn(delayedValue(loop, 30, 30ms), done);
+    loop.spawn(delayedValue(loop, 10, 10ms), done);
+    loop.spawn(delayedValue(loop, 20, 20ms), done);
+    finished.get_future().wait();
+    EXPECT_EQ(order, std::vector<int>({10, 20, 30}));
+}
+
+TEST(EventLoopTest, CallbackResumesFromAnotherThread) {
+    EventLoop loop;
+    std::thread producer;
+    auto task = [](EventLoop &loop, std::thread &producer) -> Task<int> {
+        int value = co_await loop.callback<int>([&producer](auto resume) {
+            producer = std::thread([resume] { resume(7); });
+        });
+        co_return value * 2;
+    };
+    std::promise<int> done;
+    loop.spawn(task(loop, producer), [&done](std::exception_ptr, std::optional<int> value) {
+        done.set_value(*value);
+    });
+    EXPECT_EQ(done.get_future().get(), 14);
+    producer.join();
+}
+
+TEST(EventLoopTest, CallbackAfterLoopDestroyedIsDropped) {
+    std::function<void(int)> late;
+    std::promise<void> suspended;
+    bool completed = false;
+    {
+        EventLoop loop;
+        auto task = [](EventLoop &loop, std::function<void(int)> &late, std::promise<void> &suspended) -> Task<int> {
+            co_return co_await loop.callback<int>([&](auto resume) {
+                late = resume;
+                suspended.set_value();
+            });
+        };
+        loop.spawn(task(loop, late, suspended), [&completed](std::exception_ptr, std::optional<int>) {
+            completed = true;
+        });
+        suspended.get_future().wait();
+    }
+    // 协程帧已随循环销毁，迟到的完成既不恢复协程也不调用完成回调
+    late(1);
+    EXPECT_FALSE(completed);
+}
+
+TEST(CoroutineMethodTest, BlockingProcessWaitsForResult) {
+    JsonRpcServer server;
+    server.registerMethod("slowAdd", slowAdd);
+    Json::Value response = processJson(server, R"({"jsonrpc": "2.0", "method": "slowAdd", "params": [3, 4], "id": 1})");
+    EXPECT_EQ(response["result"].asInt(), 7);
+    EXPECT_EQ(response["id"].asInt(), 1);
+}
+
+TEST(CoroutineMethodTest, InvalidParamsRejectedBeforeStart) {
+    JsonRpcServer server;
+    server.registerMethod("slowAdd", slowAdd);
+    Json::Value response = processJson(server, R"({"jsonrpc": "2.0", "method": "slowAdd", "params": [3], "id": 2})");
+    EXPECT_EQ(response["error"]["code"].asInt(), -32602);
+}
+
+TEST(CoroutineMethodTest, AsyncResultIsPollable) {
+    JsonRpcServer server;
+    server.registerMethod("slowAdd", slowAdd);
+    Json::Value accepted = processJson(server,
+            R"({"jsonrpc": "2.0", "method": "slowAdd", "params": [1, 2], "id": 3, "async": true, "client": "c1"})");
+    EXPECT_EQ(accepted["result"].asString(), "Task accepted");
+    EXPECT_FALSE(accepted.isMember("notify"));
+
+    Json::Value result = pollAsyncResult(server, "c1", 3);
+    EXPECT_EQ(result["result"].asInt(), 3);
+}
+
+TEST(CoroutineMethodTest, DetachedReplyArrivesFromLoop) {
+    JsonRpcServer server;
+    server.registerMethod("slowAdd", slowAdd);
+    std::promise<std::string> reply;
+    std::string request = R"({"jsonrpc": "2.0", "method": "slowAdd", "params": [5, 6], "id": 4})";
+    auto detach = [&reply]() -> JsonRpcServer::Replier {
+        return [&reply](std::string response) { reply.set_value(std::move(response)); };
+    };
+    // 协程方法不阻塞调用线程，响应稍后交给回调
+    std::optional<std::string> immediate = server.process(request.data(), request.size(), detach,
+                                                          std::chrono::steady_clock::now());
+    EXPECT_FALSE(immediate.has_value());
+
+    Json::Value response;
+    ASSERT_TRUE(JsonRpcProtocol::parse(reply.get_future().get(), response));
+    EXPECT_EQ(response["result"].asInt(), 11);
+    EXPECT_EQ(response["id"].asInt(), 4);
+}
@@ -0,0 +1,99 @@
+//
+// 请求期限：开始处理前已超时的请求返回 -32003 且不执行，超大、负数与非数值的 timeout 不会溢出或误判
+//
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <string>
+#include "JsonRpcServer.h"
+
+namespace {
+
+using namespace std::chrono_literals;
+
+class DeadlineTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        server.registerMethod("count", [this](int value) {
+            calls.fetch_add(1);
+            return value;
+        });
+    }
+
+    // received 早于现在 age，模拟请求在队列中等待过
+    Json::Value call(const std::string &timeout, std::chrono::milliseconds age) {
+        std::string request = R"({"jsonrpc": "2.0", "method": "count", "params": [5], "id": 9)" +
+                              (timeout.empty() ? std::string() : R"(, "timeout": )" + timeout) + "}";
+        return callRaw(request, age);
+    }
+
+    Json::Value callRaw(const std::string &request, std::chrono::milliseconds age) {
+        std::optional<std::string> raw = server.process(request.data(), request.size(), nullptr,
+                                                        std::chrono::steady_clock::now() - age);
+        Json::Value response;
+        EXPECT_TRUE(raw && JsonRpcProtocol::parse(*raw, response));
+        return response;
+    }
+
+    JsonRpcServer server;
+    std::atomic<int> calls{0};
+};
+
+} // namespace
+
+TEST_F(DeadlineTest, ExpiredRequestIsShedWithoutRunning) {
+    Json::Value response = call("10", 50ms);
+    EXPECT_EQ(response["error"]["code"].asInt(), -32003);
+    EXPECT_EQ(response["id"].asInt(), 9);
+    EXPECT_EQ(calls.load(), 0);
+    EXPECT_EQ(server.metrics()["errors"]["-32003"].asUInt64(), 1u);
+}
+
+TEST_F(DeadlineTest, RequestWithinDeadlineRuns) {
+    EXPECT_EQ(call("1000", 5ms)["result"].asInt(), 5);
+    EXPECT_EQ(call("", 1h)["result"].asInt(), 5);
+    EXPECT_EQ(calls.load(), 2);
+}
+
+TEST_F(DeadlineTest, HugeTimeoutIsClampedInsteadOfOverflowing) {
+    for (const char *timeout: {"9223372036854775807", "18446744073709551615", "1e300"}) {
+        Json::Value response = call(timeout, 1ms);
+        EXPECT_EQ(response["result"].asInt(), 5) << timeout;
+    }
+    // 截断到 24 小时后，等待更久的请求仍被丢弃
+    EXPECT_EQ(call("1e300", 25h)["error"]["code"].asInt(), -32003);
+    EXPECT_EQ(calls.load(), 3);
+}
+
+TEST_F(DeadlineTest, NegativeTimeoutCountsAsZero) {
+    EXPECT_EQ(call("-5", 1ms)["error"]["code"].asInt(), -32003);
+    EXPECT_EQ(calls.load(), 0);
+}
+
+TEST_F(DeadlineTest, NonNumericTimeoutIsIgnored) {
+    EXPECT_EQ(call(R"("soon")", 1h)["result"].asInt(), 5);
+    EXPECT_EQ(call("null", 1h)["result"].asInt(), 5);
+}
+
+TEST_F(DeadlineTest, BatchEntriesShareReceiveTime) {
+    Json::Value response = callRaw(R"([
+        {"jsonrpc": "2.0", "method": "count", "params": [1], "id": 1, "timeout": 10},
+        {"jsonrpc": "2.0", "method": "count", "params": [2], "id": 2, "timeout": 100000},
+        {"jsonrpc": "2.0", "method": "count", "params": [3], "id": 3}
+    ])", 50ms);
+    ASSERT_EQ(response.size(), 3u);
+    EXPECT_EQ(response[0]["error"]["code"].asInt(), -32003);
+    EXPECT_EQ(response[1]["result"].asInt(), 2);
+    EXPECT_EQ(response[2]["result"].asInt(), 3);
+    EXPECT_EQ(calls.load(), 2);
+}
+
+TEST_F(DeadlineTest, ExpiredAsyncRequestIsNotQueued) {
+    Json::Value response = callRaw(
+            R"({"jsonrpc": "2.0", "method": "count", "params": [1], "id": 4, "timeout": 1, "async": true, "client": "c"})",
+            20ms);
+    EXPECT_EQ(response["error"]["code"].asInt(), -32003);
+    EXPECT_EQ(server.asyncResultStats().size, 0u);
+}
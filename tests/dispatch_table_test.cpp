@@ -0,0 +1,60 @@
+//
+// DispatchTable：查找、复制式插入与遍历顺序
+//
+
+#include <gtest/gtest.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include "DispatchTable.h"
+
+TEST(DispatchTableTest, EmptyTableFindsNothing) {
+    DispatchTable<int> table;
+    EXPECT_EQ(table.size(), 0u);
+    EXPECT_EQ(table.find("add"), nullptr);
+    EXPECT_EQ(table.find(""), nullptr);
+}
+
+TEST(DispatchTableTest, FindsEveryKey) {
+    std::vector<std::pair<std::string, int>> entries;
+    for (int i = 0; i < 1000; ++i) entries.emplace_back("method." + std::to_string(i), i);
+    DispatchTable<int> table(std::move(entries));
+
+    ASSERT_EQ(table.size(), 1000u);
+    for (int i = 0; i < 1000; ++i) {
+        const int *value = table.find("method." + std::to_string(i));
+        ASSERT_NE(value, nullptr) << i;
+        EXPECT_EQ(*value, i);
+    }
+    EXPECT_EQ(table.find("method.1000"), nullptr);
+    EXPECT_EQ(table.find("method."), nullptr);
+}
+
+TEST(DispatchTableTest, WithCopiesAndLeavesOriginalUnchanged) {
+    DispatchTable<int> base({{"add", 1}, {"sub", 2}});
+    auto added = base.with("mul", 3);
+    auto replaced = added.with("add", 10);
+
+    EXPECT_EQ(base.size(), 2u);
+    EXPECT_EQ(base.find("mul"), nullptr);
+    EXPECT_EQ(*base.find("add"), 1);
+
+    EXPECT_EQ(added.size(), 3u);
+    EXPECT_EQ(*added.find("mul"), 3);
+    EXPECT_EQ(*added.find("add"), 1);
+
+    EXPECT_EQ(replaced.size(), 3u);
+    EXPECT_EQ(*replaced.find("add"), 10);
+    EXPECT_EQ(*replaced.find("sub"), 2);
+}
+
+TEST(DispatchTableTest, ForEachVisitsInInsertionOrder) {
+    DispatchTable<int> table({{"c", 3}, {"a", 1}, {"b", 2}});
+    table = table.with("a", 4);
+    std::vector<std::pair<std::string, int>> visited;
+    table.forEach([&visited](const std::string &key, int value) { visited.emplace_back(key, value); });
+
+    // 覆盖的键移到末尾
+    std::vector<std::pair<std::string, int>> expected{{"c", 3}, {"b", 2}, {"a", 4}};
+    EXPECT_EQ(visited, expected);
+}
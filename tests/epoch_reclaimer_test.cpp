@@ -0,0 +1,124 @@
+//
+// EpochReclaimer：无读者时立即释放，读者在临界区内时推迟释放，并发替换下读者不读到已释放对象
+//
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "EpochReclaimer.h"
+
+namespace {
+
+struct Tracked {
+    static constexpr uint64_t kAlive = 0x5a5a5a5a5a5a5a5a;
+
+    explicit Tracked(std::atomic<int> &destroyed, uint64_t value = 0) : destroyed(destroyed), value(value) {}
+
+    ~Tracked() {
+        magic = 0;
+        destroyed.fetch_add(1);
+    }
+
+    std::atomic<int> &destroyed;
+    uint64_t value;
+    volatile uint64_t magic = kAlive;
+};
+
+} // namespace
+
+TEST(EpochReclaimerTest, FreesImmediatelyWithoutReaders) {
+    std::atomic<int> destroyed{0};
+    EpochReclaimer reclaimer;
+    reclaimer.retire(std::make_unique<Tracked>(destroyed));
+    EXPECT_EQ(reclaimer.pending(), 0u);
+    EXPECT_EQ(destroyed.load(), 1);
+}
+
+TEST(EpochReclaimerTest, ReaderDelaysFree) {
+    std::atomic<int> destroyed{0};
+    EpochReclaimer reclaimer;
+    std::atomic<bool> entered{false};
+    std::atomic<bool> leave{false};
+    std::thread reader([&] {
+        EpochReclaimer::Guard guard;
+        {
+            // 嵌套进入不改变登记的纪元
+            EpochReclaimer::Guard nested;
+        }
+        entered = true;
+        while (!leave) std::this_thread::yield();
+    });
+    while (!entered) std::this_thread::yield();
+
+    reclaimer.retire(std::make_unique<Tracked>(destroyed));
+    EXPECT_EQ(reclaimer.pending(), 1u);
+    EXPECT_EQ(destroyed.load(), 0);
+
+    leave = true;
+    reader.join();
+    reclaimer.collect();
+    EXPECT_EQ(reclaimer.pending(), 0u);
+    EXPECT_EQ(destroyed.load(), 1);
+}
+
+TEST(EpochReclaimerTest, ReaderEnteringAfterRetireDoesNotBlockFree) {
+    std::atomic<int> destroyed{0};
+    EpochReclaimer reclaimer;
+    std::atomic<bool> leave{false};
+    std::atomic<bool> entered{false};
+    // 替换之前进入的读者
+    std::thread early([&] {
+        EpochReclaimer::Guard guard;
+        entered = true;
+        while (!leave) std::this_thread::yield();
+    });
+    while (!entered) std::this_thread::yield();
+    reclaimer.retire(std::make_unique<Tracked>(destroyed));
+    EXPECT_EQ(reclaimer.pending(), 1u);
+
+    // 替换之后进入的读者只可能看到新对象，不应阻止回收
+    EpochReclaimer::Guard late;
+    leave = true;
+    early.join();
+    reclaimer.collect();
+    EXPECT_EQ(reclaimer.pending(), 0u);
+    EXPECT_EQ(destroyed.load(), 1);
+}
+
+TEST(EpochReclaimerTest, ConcurrentReadersNeverSeeFreedObject) {
+    constexpr int kReaders = 4;
+    constexpr uint64_t kSwaps = 20000;
+    std::atomic<int> destroyed{0};
+    EpochReclaimer reclaimer;
+    std::atomic<Tracked *> current{new Tracked(destroyed, 0)};
+    std::atomic<bool> stop{false};
+    std::atomic<bool> corrupt{false};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < kReaders; ++r) {
+        readers.emplace_back([&] {
+            uint64_t last = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                EpochReclaimer::Guard guard;
+                Tracked *object = current.load(std::memory_order_seq_cst);
+                // 写者单调递增 value，读到已释放或倒退的对象都说明回收过早
+                if (object->magic != Tracked::kAlive || object->value < last) corrupt = true;
+                last = object->value;
+            }
+        });
+    }
+    for (uint64_t i = 1; i <= kSwaps; ++i) {
+        std::unique_ptr<Tracked> old(current.exchange(new Tracked(destroyed, i), std::memory_order_seq_cst));
+        reclaimer.retire(std::move(old));
+    }
+    stop = true;
+    for (auto &thread: readers) thread.join();
+    reclaimer.collect();
+
+    EXPECT_FALSE(corrupt.load());
+    EXPECT_EQ(reclaimer.pending(), 0u);
+    EXPECT_EQ(destroyed.load(), static_cast<int>(kSwaps));
+    delete current.load();
+}
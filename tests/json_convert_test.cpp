@@ -0,0 +1,155 @@
+//
+// 参数与返回值的类型转换：各内置类型、容器与 JSONRPC_REFLECT 结构体的编解码与错误信息，
+// 以及按签名生成的调用器在服务器上的参数个数与类型检查
+//
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "JsonConvert.h"
+#include "JsonRpcServer.h"
+#include "test_util.h"
+
+struct ConvertPoint {
+    int x = 0;
+    double y = 0;
+    std::optional<std::string> label;
+    std::vector<int> tags;
+};
+JSONRPC_REFLECT(ConvertPoint, x, y, label, tags)
+
+namespace {
+
+Json::Value parse(const std::string &text) {
+    Json::Value value;
+    EXPECT_TRUE(JsonRpcProtocol::parse(text, value)) << text;
+    return value;
+}
+
+template<typename T>
+std::string decodeError(const std::string &text) {
+    try {
+        fromJson<T>(parse(text));
+    } catch (const std::invalid_argument &e) {
+        return e.what();
+    }
+    return "";
+}
+
+int add(int a, int b) {
+    return a + b;
+}
+
+class Counter {
+public:
+    int bump(int by) { return m_value += by; }
+
+    int value() const { return m_value; }
+
+private:
+    int m_value = 0;
+};
+
+} // namespace
+
+TEST(JsonConvertTest, DecodesScalars) {
+    EXPECT_TRUE(fromJson<bool>(parse("true")));
+    EXPECT_EQ(fromJson<int>(parse("-5")), -5);
+    EXPECT_EQ(fromJson<int>(parse("4.0")), 4);
+    EXPECT_EQ(fromJson<uint64_t>(parse("18446744073709551615")), UINT64_MAX);
+    EXPECT_EQ(fromJson<int8_t>(parse("-128")), -128);
+    EXPECT_DOUBLE_EQ(fromJson<double>(parse("3")), 3.0);
+    EXPECT_FLOAT_EQ(fromJson<float>(parse("0.5")), 0.5f);
+    EXPECT_EQ(fromJson<std::string>(parse(R"("a\"b")")), "a\"b");
+    Json::Value text = parse(R"("view")");
+    EXPECT_EQ(fromJson<std::string_view>(text), "view");
+}
+
+TEST(JsonConvertTest, RejectsMismatchedScalars) {
+    EXPECT_EQ(decodeError<bool>("1"), "expected boolean");
+    EXPECT_EQ(decodeError<int>(R"("1")"), "expected integer");
+    EXPECT_EQ(decodeError<int>("1.5"), "expected integer");
+    EXPECT_EQ(decodeError<int>("2147483648"), "integer out of range");
+    EXPECT_EQ(decodeError<int8_t>("128"), "integer out of range");
+    EXPECT_EQ(decodeError<unsigned>("-1"), "expected unsigned integer");
+    EXPECT_EQ(decodeError<double>("true"), "expected number");
+    EXPECT_EQ(decodeError<std::string>("null"), "expected string");
+    EXPECT_EQ(decodeError<std::string_view>("1"), "expected string");
+}
+
+TEST(JsonConvertTest, ContainersAndOptional) {
+    EXPECT_EQ(fromJson<std::vector<int>>(parse("[1, 2, 3]")), (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(fromJson<std::vector<std::vector<std::string>>>(parse(R"([["a"], []])")),
+              (std::vector<std::vector<std::string>>{{"a"}, {}}));
+    EXPECT_EQ(decodeError<std::vector<int>>(R"({"a": 1})"), "expected array");
+    EXPECT_EQ(decodeError<std::vector<int>>(R"([1, "x"])"), "expected integer");
+    EXPECT_EQ(fromJson<std::optional<int>>(parse("null")), std::nullopt);
+    EXPECT_EQ(fromJson<std::optional<int>>(parse("7")), 7);
+    EXPECT_EQ(toJson(std::optional<int>()), Json::Value());
+    EXPECT_EQ(toJson(std::vector<bool>{true, false}), parse("[true, false]"));
+}
+
+TEST(JsonConvertTest, ReflectedStructs) {
+    ConvertPoint point = fromJson<ConvertPoint>(parse(R"({"x": 1, "y": 2.5, "tags": [3], "extra": 0})"));
+    EXPECT_EQ(point.x, 1);
+    EXPECT_DOUBLE_EQ(point.y, 2.5);
+    EXPECT_FALSE(point.label);
+    EXPECT_EQ(point.tags, std::vector<int>{3});
+    EXPECT_EQ(decodeError<ConvertPoint>(R"({"x": "1", "y": 0, "tags": []})"), "x: expected integer");
+    // 缺失的非 optional 字段按 null 解码而报错
+    EXPECT_EQ(decodeError<ConvertPoint>(R"({"x": 1, "tags": []})"), "y: expected number");
+    EXPECT_EQ(decodeError<ConvertPoint>("[]"), "expected object");
+
+    point.label = "p";
+    Json::Value encoded = toJson(point);
+    EXPECT_EQ(encoded["label"], "p");
+    EXPECT_EQ(encoded["tags"][0].asInt(), 3);
+    EXPECT_EQ(fromJson<ConvertPoint>(encoded).label, "p");
+}
+
+TEST(JsonConvertTest, IntegersEncodeWithSignedness) {
+    EXPECT_EQ(toJson(static_cast<uint8_t>(200)).type(), Json::uintValue);
+    EXPECT_EQ(toJson(static_cast<int16_t>(-2)).type(), Json::intValue);
+    EXPECT_EQ(toJson(std::string_view("sv")), "sv");
+    EXPECT_EQ(toJson("literal"), "literal");
+}
+
+TEST(JsonConvertTest, ServerChecksArityAndTypes) {
+    JsonRpcServer server;
+    Counter counter;
+    server.registerMethod<&add>("add");
+    server.registerMethod<&Counter::bump>("bump", &counter);
+    server.registerMethod("mid", [](const ConvertPoint &a, const ConvertPoint &b) {
+        return ConvertPoint{(a.x + b.x) / 2, (a.y + b.y) / 2, std::nullopt, {}};
+    });
+    server.registerMethod("length", [](std::string_view text) { return text.size(); });
+    server.registerMethod("noop", [] {});
+
+    auto call = [&](const std::string &method, const std::string &params) {
+        return processJson(server, R"({"jsonrpc": "2.0", "method": ")" + method + R"(", "params": )" + params +
+                                   R"(, "id": 1})");
+    };
+    EXPECT_EQ(call("add", "[2, 3]")["result"].asInt(), 5);
+    EXPECT_EQ(call("bump", "[4]")["result"].asInt(), 4);
+    EXPECT_EQ(call("bump", "[1]")["result"].asInt(), 5);
+    EXPECT_EQ(counter.value(), 5);
+    Json::Value mid = call("mid", R"([{"x": 0, "y": 0, "tags": []}, {"x": 4, "y": 1, "tags": []}])")["result"];
+    EXPECT_EQ(mid["x"].asInt(), 2);
+    EXPECT_TRUE(mid["label"].isNull());
+    EXPECT_EQ(call("length", R"(["four"])")["result"].asUInt(), 4u);
+    EXPECT_TRUE(call("noop", "[]")["result"].isNull());
+    EXPECT_TRUE(call("noop", "null")["result"].isNull());
+
+    Json::Value error = call("add", "[1]")["error"];
+    EXPECT_EQ(error["code"].asInt(), -32602);
+    EXPECT_EQ(error["message"], "Invalid parameters: Incorrect number of arguments");
+    EXPECT_EQ(call("add", "[1, 2, 3]")["error"]["code"].asInt(), -32602);
+    EXPECT_EQ(call("add", R"([1, "2"])")["error"]["message"], "Invalid parameters: expected integer");
+    Json::Value badTags = call("mid", R"([{"x": 0, "y": 0, "tags": [true]}, {"x": 0, "y": 0, "tags": []}])");
+    EXPECT_EQ(badTags["error"]["message"], "Invalid parameters: tags: expected integer");
+    EXPECT_EQ(call("noop", "[1]")["error"]["code"].asInt(), -32602);
+}
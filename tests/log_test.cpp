@@ -0,0 +1,117 @@
+//
+// 日志：文件打不开时退回 stderr 并只报告一次，flush 在多线程写入下等到全部写出后返回，格式由第一次 init 决定，
+// 回收复用的行缓冲不会残留上一行的内容
+//
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+#include "log/log.h"
+
+namespace {
+
+// 用例结束后恢复服务器使用的默认配置
+class LogTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        Log::Instance()->flush();
+        Log::Instance()->init(0);
+    }
+};
+
+std::string readAll(const std::string &dir) {
+    std::string content;
+    for (const auto &entry: std::filesystem::directory_iterator(dir)) {
+        std::ifstream in(entry.path(), std::ios::binary);
+        content.append(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    return content;
+}
+
+size_t countOf(const std::string &text, const std::string &needle) {
+    size_t count = 0;
+    for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) {
+        ++count;
+    }
+    return count;
+}
+
+} // namespace
+
+TEST_F(LogTest, UnopenableFileFallsBackToStderr) {
+    ::testing::internal::CaptureStderr();
+    // /proc 下无法创建目录与文件
+    Log::Instance()->init(1, "/proc/jsonrpc-log-test");
+    LOG_INFO("fallback line {}", 1)
+    LOG_INFO("fallback line {}", 2)
+    Log::Instance()->flush();
+    std::string err = ::testing::internal::GetCapturedStderr();
+    EXPECT_EQ(countOf(err, "cannot open"), 1u) << err;
+    EXPECT_NE(err.find("fallback line 1"), std::string::npos);
+    EXPECT_NE(err.find("fallback line 2"), std::string::npos);
+}
+
+TEST_F(LogTest, FlushWaitsForConcurrentWriters) {
+    Log::Instance()->init(1, "./log", ".log", 64);
+    std::vector<std::thread> writers;
+    std::atomic<int> flushed{0};
+    for (int t = 0; t < 4; ++t) {
+        writers.emplace_back([t, &flushed] {
+            for (int i = 0; i < 2000; ++i) {
+                LOG_INFO("writer {} line {}", t, i)
+                if (i % 500 == 0) {
+                    Log::Instance()->flush();
+                    flushed.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (auto &writer: writers) {
+        writer.join();
+    }
+    Log::Instance()->flush();
+    EXPECT_EQ(flushed.load(), 16);
+}
+
+TEST_F(LogTest, FormatIsFixedByFirstInit) {
+    // 保证已以文本格式打开；init 只保存路径指针，目录名需一直有效
+    Log::Instance()->init(1);
+    static const std::string dir = ::testing::TempDir() + "jsonrpc-log-format";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    ::testing::internal::CaptureStderr();
+    Log::Instance()->init(1, dir.c_str(), ".bin", 1024, true);
+    std::string err = ::testing::internal::GetCapturedStderr();
+    EXPECT_NE(err.find("format is fixed"), std::string::npos) << err;
+    LOG_INFO("still text {}", 7)
+    Log::Instance()->flush();
+    EXPECT_NE(readAll(dir).find("[info] : still text 7\n"), std::string::npos);
+}
+
+TEST_F(LogTest, RecycledLinesStartEmpty) {
+    static const std::string dir = ::testing::TempDir() + "jsonrpc-log-recycle";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    Log::Instance()->init(1, dir.c_str());
+    const std::string longText(5000, 'x');
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 200; ++i) {
+            LOG_INFO("line {}-{}", round, i)
+        }
+        LOG_INFO("long {}", longText)
+        // 让写线程把串还回空闲表，下一轮取到的都是用过的串
+        Log::Instance()->flush();
+    }
+    std::string content = readAll(dir);
+    EXPECT_EQ(countOf(content, "[info] : line "), 600u);
+    EXPECT_EQ(countOf(content, "[info] : long x"), 3u);
+    EXPECT_NE(content.find("[info] : line 2-199\n"), std::string::npos);
+    // 每行都以时间前缀开头，没有拼在上一行残留内容之后
+    EXPECT_EQ(countOf(content, "\n"), 603u);
+    EXPECT_EQ(countOf(content, "\n20"), 602u);
+}
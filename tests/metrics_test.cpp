@@ -0,0 +1,115 @@
+//
+// 运行指标：直方图分位的误差范围、错误码分桶、调用数精确而耗时按周期采样，以及解析与序列化的计时
+//
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "JsonRpcServer.h"
+#include "Metrics.h"
+#include "test_util.h"
+
+namespace {
+
+using namespace std::chrono_literals;
+
+// 恢复进程内共享的采样周期，避免影响其他用例
+class SamplingGuard {
+public:
+    explicit SamplingGuard(uint32_t period) : m_saved(LatencySampler::period()) {
+        JsonRpcServer::setLatencySampling(period);
+    }
+
+    ~SamplingGuard() { LatencySampler::setPeriod(m_saved); }
+
+private:
+    uint32_t m_saved;
+};
+
+std::string addRequest(int id, const std::string &params = "[1, 2]") {
+    return R"({"jsonrpc": "2.0", "method": "add", "params": )" + params + R"(, "id": )" + std::to_string(id) + "}";
+}
+
+} // namespace
+
+TEST(LatencyHistogramTest, PercentilesWithinBucketError) {
+    LatencyHistogram histogram;
+    for (int i = 1; i <= 1000; ++i) {
+        histogram.record(std::chrono::microseconds(i));
+    }
+    LatencyHistogram::Summary summary = histogram.summary();
+    EXPECT_EQ(summary.count, 1000u);
+    EXPECT_NEAR(summary.meanMicros, 500.5, 0.01);
+    EXPECT_NEAR(summary.p50Micros, 500, 500 / 16.0);
+    EXPECT_NEAR(summary.p99Micros, 990, 990 / 16.0);
+    EXPECT_DOUBLE_EQ(summary.maxMicros, 1000);
+    EXPECT_LE(summary.p999Micros, summary.maxMicros);
+}
+
+TEST(ErrorCountsTest, UnknownCodesFoldIntoOther) {
+    ErrorCounts errors;
+    errors.add(-32602);
+    errors.add(-32602);
+    errors.add(-32004);
+    std::vector<std::pair<int, uint64_t>> seen;
+    errors.forEach([&seen](int code, uint64_t count) { seen.emplace_back(code, count); });
+    std::vector<std::pair<int, uint64_t>> expected = {{-32602, 2}, {0, 1}};
+    EXPECT_EQ(seen, expected);
+}
+
+TEST(LatencySamplerTest, SitesCountIndependently) {
+    SamplingGuard sampling(4);
+    int requests = 0;
+    int methods = 0;
+    for (int i = 0; i < 16; ++i) {
+        requests += LatencySampler::sample(LatencySampler::Request);
+        methods += LatencySampler::sample(LatencySampler::Method);
+    }
+    EXPECT_EQ(requests, 4);
+    EXPECT_EQ(methods, 4);
+}
+
+TEST(ServerMetricsTest, CallsAreExactWhileLatencyIsSampled) {
+    SamplingGuard sampling(4);
+    JsonRpcServer server;
+    server.registerMethod("add", [](int a, int b) { return a + b; });
+    for (int i = 0; i < 40; ++i) {
+        processJson(server, addRequest(i));
+    }
+    processJson(server, addRequest(41, R"(["x", 1])"));
+    Json::Value metrics = server.metrics();
+    const Json::Value &add = metrics["methods"]["add"];
+    EXPECT_EQ(add["calls"].asUInt64(), 41u);
+    EXPECT_EQ(add["errors"]["-32602"].asUInt64(), 1u);
+    EXPECT_GE(add["latency"]["count"].asUInt64(), 10u);
+    EXPECT_LE(add["latency"]["count"].asUInt64(), 11u);
+    EXPECT_GE(metrics["parse"]["count"].asUInt64(), 10u);
+    EXPECT_EQ(metrics["parse"]["count"], metrics["serialize"]["count"]);
+}
+
+TEST(ServerMetricsTest, PeriodOneTimesEveryCall) {
+    SamplingGuard sampling(1);
+    JsonRpcServer server;
+    server.registerMethod("add", [](int a, int b) { return a + b; });
+    for (int i = 0; i < 5; ++i) {
+        processJson(server, addRequest(i));
+    }
+    Json::Value metrics = server.metrics("add");
+    EXPECT_EQ(metrics["methods"]["add"]["latency"]["count"].asUInt64(), 5u);
+    // 按方法查询时不带全局字段
+    EXPECT_FALSE(metrics.isMember("parse"));
+    EXPECT_EQ(server.metrics()["parse"]["count"].asUInt64(), 5u);
+}
+
+TEST(ServerMetricsTest, GetMetricsBuiltin) {
+    JsonRpcServer server;
+    server.registerMethod("add", [](int a, int b) { return a + b; });
+    processJson(server, addRequest(1));
+    processJson(server, R"({"jsonrpc": "2.0", "method": "missing", "id": 2})");
+    Json::Value response = processJson(server, R"({"jsonrpc": "2.0", "method": "getMetrics", "params": ["add"], "id": 3})");
+    EXPECT_EQ(response["result"]["methods"]["add"]["calls"].asUInt64(), 1u);
+    EXPECT_EQ(server.metrics()["errors"]["-32601"].asUInt64(), 1u);
+}
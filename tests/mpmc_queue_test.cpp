@@ -0,0 +1,151 @@
+//
+// MpmcQueue：容量、满/空、关闭语义、批量接口与多生产者多消费者压力
+//
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "log/mpmcqueue.h"
+
+TEST(MpmcQueueTest, CapacityRoundsUpToPowerOfTwo) {
+    EXPECT_EQ(MpmcQueue<int>(5).capacity(), 8u);
+    EXPECT_EQ(MpmcQueue<int>(8).capacity(), 8u);
+    EXPECT_EQ(MpmcQueue<int>(1).capacity(), 2u);
+}
+
+TEST(MpmcQueueTest, FifoAndFullEmpty) {
+    MpmcQueue<int> queue(4);
+    for (int i = 0; i < 4; ++i) ASSERT_TRUE(queue.tryPush(int(i)));
+    EXPECT_FALSE(queue.tryPush(4));
+    EXPECT_EQ(queue.size(), 4u);
+
+    int value = -1;
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(queue.tryPop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(queue.tryPop(value));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(MpmcQueueTest, CloseDrainsRemainingItems) {
+    MpmcQueue<int> queue(8);
+    ASSERT_TRUE(queue.push(1));
+    ASSERT_TRUE(queue.push(2));
+    queue.close();
+    EXPECT_TRUE(queue.closed());
+    EXPECT_FALSE(queue.push(3));
+    EXPECT_FALSE(queue.tryPush(3));
+
+    int value = 0;
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, 1);
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, 2);
+    EXPECT_FALSE(queue.pop(value));
+}
+
+TEST(MpmcQueueTest, CloseWakesBlockedConsumer) {
+    MpmcQueue<int> queue(8);
+    std::thread consumer([&queue] {
+        int value;
+        EXPECT_FALSE(queue.pop(value));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.close();
+    consumer.join();
+}
+
+TEST(MpmcQueueTest, TimedPopReturnsFalseWhenEmpty) {
+    MpmcQueue<int> queue(8);
+    int value;
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(queue.pop(value, std::chrono::milliseconds(20)));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+
+    std::vector<int> out;
+    EXPECT_EQ(queue.popN(out, 4, std::chrono::milliseconds(5)), 0u);
+}
+
+TEST(MpmcQueueTest, HoldsMoveOnlyItems) {
+    MpmcQueue<std::unique_ptr<int>> queue(4);
+    auto item = std::make_unique<int>(7);
+    ASSERT_TRUE(queue.push(std::move(item)));
+    EXPECT_EQ(item, nullptr);
+
+    std::unique_ptr<int> out;
+    ASSERT_TRUE(queue.pop(out));
+    ASSERT_NE(out, nullptr);
+    EXPECT_EQ(*out, 7);
+}
+
+TEST(MpmcQueueTest, BatchPushAndPop) {
+    MpmcQueue<int> queue(8);
+    std::vector<int> items{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    // 只放得下 8 个
+    EXPECT_EQ(queue.tryPushN(items.data(), items.size()), 8u);
+
+    std::vector<int> out;
+    EXPECT_EQ(queue.tryPopN(out, 3), 3u);
+    EXPECT_EQ(queue.popN(out, 100), 5u);
+    EXPECT_EQ(out, std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7}));
+
+    EXPECT_EQ(queue.pushN(items.data() + 8, 2), 2u);
+    out.clear();
+    EXPECT_EQ(queue.popN(out, 100), 2u);
+    EXPECT_EQ(out, std::vector<int>({8, 9}));
+}
+
+TEST(MpmcQueueTest, ManyProducersManyConsumers) {
+    constexpr int kProducers = 4;
+    constexpr int kConsumers = 4;
+    constexpr uint64_t kPerProducer = 100000;
+    // 容量远小于总量，生产者与消费者都会在满/空时阻塞
+    MpmcQueue<uint64_t> queue(64);
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < kConsumers; ++c) {
+        consumers.emplace_back([&, c] {
+            uint64_t localCount = 0;
+            uint64_t localSum = 0;
+            if (c % 2 == 0) {
+                uint64_t value;
+                while (queue.pop(value)) {
+                    ++localCount;
+                    localSum += value;
+                }
+            } else {
+                std::vector<uint64_t> batch;
+                while (queue.popN(batch, 16) > 0) {
+                    for (uint64_t value: batch) localSum += value;
+                    localCount += batch.size();
+                    batch.clear();
+                }
+            }
+            count.fetch_add(localCount);
+            sum.fetch_add(localSum);
+        });
+    }
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&queue, p] {
+            for (uint64_t i = 0; i < kPerProducer; ++i) {
+                ASSERT_TRUE(queue.push(p * kPerProducer + i + 1));
+            }
+        });
+    }
+    for (auto &thread: producers) thread.join();
+    queue.close();
+    for (auto &thread: consumers) thread.join();
+
+    constexpr uint64_t kTotal = kProducers * kPerProducer;
+    EXPECT_EQ(count.load(), kTotal);
+    EXPECT_EQ(sum.load(), kTotal * (kTotal + 1) / 2);
+    EXPECT_TRUE(queue.empty());
+}
@@ -0,0 +1,134 @@
+//
+// MessagePack 编解码：各类型与各长度档位往返不变，按最短格式编码，截断、多余字节、ext 与非字符串键被拒绝；
+// MessagePack 请求得到同样编码的响应
+//
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+#include "JsonRpcServer.h"
+#include "MsgPackCodec.h"
+
+namespace {
+
+std::string encode(const Json::Value &value) {
+    std::string out;
+    MsgPackCodec::write(value, out);
+    return out;
+}
+
+bool decode(const std::string &bytes, Json::Value &out) {
+    return MsgPackCodec::parse(bytes.data(), bytes.data() + bytes.size(), out, nullptr);
+}
+
+Json::Value roundTrip(const Json::Value &value) {
+    Json::Value decoded;
+    EXPECT_TRUE(decode(encode(value), decoded)) << value.toStyledString();
+    return decoded;
+}
+
+} // namespace
+
+TEST(MsgPackCodecTest, ScalarsRoundTrip) {
+    const std::vector<Json::Value> values = {
+            Json::Value(), Json::Value(true), Json::Value(false), Json::Value(0), Json::Value(127),
+            Json::Value(128), Json::Value(65535), Json::Value(65536),
+            Json::Value(static_cast<Json::Int64>(1) << 32),
+            Json::Value(std::numeric_limits<Json::Int64>::max()),
+            Json::Value(std::numeric_limits<Json::UInt64>::max()),
+            Json::Value(-1), Json::Value(-32), Json::Value(-33), Json::Value(-128), Json::Value(-129),
+            Json::Value(-32768), Json::Value(-32769), Json::Value(std::numeric_limits<Json::Int64>::min()),
+            Json::Value(1.5), Json::Value(-0.1), Json::Value(1e300),
+    };
+    for (const auto &value: values) {
+        EXPECT_EQ(roundTrip(value), value) << value.toStyledString();
+    }
+}
+
+TEST(MsgPackCodecTest, StringsAndContainersRoundTrip) {
+    for (size_t size: {0, 31, 32, 255, 256, 65535, 65536}) {
+        Json::Value text(std::string(size, 'x'));
+        EXPECT_EQ(roundTrip(text), text) << size;
+    }
+    Json::Value nested(Json::objectValue);
+    for (int i = 0; i < 20; ++i) {
+        nested["key" + std::to_string(i)] = i;
+        nested["list"].append(Json::Value(std::string(1, static_cast<char>('a' + i))));
+    }
+    nested["empty"] = Json::Value(Json::arrayValue);
+    nested["inner"]["null"] = Json::Value();
+    EXPECT_EQ(roundTrip(nested), nested);
+}
+
+TEST(MsgPackCodecTest, UsesShortestEncoding) {
+    EXPECT_EQ(encode(Json::Value(127)).size(), 1u);
+    EXPECT_EQ(encode(Json::Value(128)), std::string("\xcc\x80", 2));
+    EXPECT_EQ(encode(Json::Value(-32)).size(), 1u);
+    EXPECT_EQ(encode(Json::Value(-33)), std::string("\xd0\xdf", 2));
+    EXPECT_EQ(encode(Json::Value(65536)).size(), 5u);
+    EXPECT_EQ(encode(Json::Value("abc")), std::string("\xa3" "abc", 4));
+    EXPECT_EQ(encode(Json::Value(std::string(32, 'x'))).size(), 34u);
+    EXPECT_EQ(encode(Json::Value(2.0)).size(), 9u);
+}
+
+TEST(MsgPackCodecTest, DecodesBinAndFloat32) {
+    Json::Value value;
+    ASSERT_TRUE(decode(std::string("\xc4\x02hi", 4), value));
+    EXPECT_EQ(value, "hi");
+    ASSERT_TRUE(decode(std::string("\xca\x3f\xc0\x00\x00", 5), value));
+    EXPECT_DOUBLE_EQ(value.asDouble(), 1.5);
+}
+
+TEST(MsgPackCodecTest, RejectsMalformedPayloads) {
+    const std::vector<std::string> payloads = {
+            std::string("\x92\x01", 2),             // 数组声明 2 个元素只有 1 个
+            std::string("\xa5" "abc", 4),           // 字符串长度超出负载
+            std::string("\xcd\x01", 2),             // uint16 截断
+            std::string("\x91\x01\x02", 3),         // 多余字节
+            std::string("\xd4\x01\x02", 3),         // fixext 1
+            std::string("\x81\x01\x02", 3),         // 整数键
+            std::string("\xc1", 1),                 // 保留字节
+    };
+    for (const auto &payload: payloads) {
+        Json::Value value;
+        std::string errs;
+        EXPECT_FALSE(MsgPackCodec::parse(payload.data(), payload.data() + payload.size(), value, &errs));
+        EXPECT_FALSE(errs.empty());
+    }
+    // 超过最大嵌套深度
+    std::string deep(600, '\x91');
+    deep.push_back('\x01');
+    Json::Value value;
+    EXPECT_FALSE(decode(deep, value));
+}
+
+TEST(MsgPackCodecTest, ServerAnswersInRequestEncoding) {
+    JsonRpcServer server;
+    server.registerMethod("concat", [](const std::string &a, const std::string &b) { return a + b; });
+    Json::Value request = JsonRpcProtocol::createRequest("concat", Json::Value(Json::arrayValue), 4, false);
+    request["params"].append("ab");
+    request["params"].append("cd");
+    std::string reply = server.process(encode(request));
+    ASSERT_EQ(JsonRpcProtocol::detectEncoding(reply.data(), reply.data() + reply.size()),
+              JsonRpcProtocol::Encoding::MsgPack);
+    Json::Value response;
+    ASSERT_TRUE(decode(reply, response));
+    EXPECT_EQ(response["result"], "abcd");
+    EXPECT_EQ(response["id"].asInt(), 4);
+
+    Json::Value batch(Json::arrayValue);
+    batch.append(request);
+    request["id"] = 5;
+    request["params"][1] = 1;
+    batch.append(request);
+    ASSERT_TRUE(decode(server.process(encode(batch)), response));
+    ASSERT_EQ(response.size(), 2u);
+    EXPECT_EQ(response[0]["result"], "abcd");
+    EXPECT_EQ(response[1]["error"]["code"].asInt(), -32602);
+
+    std::string garbage("\x92\x01", 2);
+    ASSERT_TRUE(decode(server.process(garbage), response));
+    EXPECT_EQ(response["error"]["code"].asInt(), -32700);
+}
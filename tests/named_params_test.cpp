@@ -0,0 +1,92 @@
+//
+// 按名传参：对象参数按名字对应形参、与成员顺序无关，缺失的参数按 null 解码，未知名字报错，数组仍按位置传参；
+// 注册时检查名字个数与重名
+//
+
+#include <gtest/gtest.h>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include "Coroutine.h"
+#include "JsonRpcServer.h"
+#include "test_util.h"
+
+namespace {
+
+int divide(int dividend, int divisor) {
+    if (divisor == 0) throw std::invalid_argument("division by zero");
+    return dividend / divisor;
+}
+
+class Greeter {
+public:
+    std::string greet(const std::string &name, std::optional<std::string> title) const {
+        return "hello " + (title ? *title + " " : "") + name;
+    }
+};
+
+Task<int> scaled(int value, int factor) {
+    co_return value * factor;
+}
+
+class NamedParamsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        server.registerMethod<&divide>("divide", ParamNames{"dividend", "divisor"});
+        server.registerMethod("greet", &Greeter::greet, &greeter, ParamNames{"name", "title"});
+        server.registerMethod("scaled", scaled, ParamNames{"value", "factor"});
+    }
+
+    Json::Value call(const std::string &method, const std::string &params) {
+        return processJson(server, R"({"jsonrpc": "2.0", "method": ")" + method + R"(", "params": )" + params +
+                                   R"(, "id": 1})");
+    }
+
+    JsonRpcServer server;
+    Greeter greeter;
+};
+
+} // namespace
+
+TEST_F(NamedParamsTest, ObjectParamsMatchByName) {
+    EXPECT_EQ(call("divide", R"({"dividend": 9, "divisor": 3})")["result"].asInt(), 3);
+    EXPECT_EQ(call("divide", R"({"divisor": 3, "dividend": 9})")["result"].asInt(), 3);
+    EXPECT_EQ(call("greet", R"({"title": "dr", "name": "x"})")["result"], "hello dr x");
+    EXPECT_EQ(call("scaled", R"({"factor": 4, "value": 5})")["result"].asInt(), 20);
+}
+
+TEST_F(NamedParamsTest, ArraysStayPositional) {
+    EXPECT_EQ(call("divide", "[8, 2]")["result"].asInt(), 4);
+    EXPECT_EQ(call("greet", R"(["y", null])")["result"], "hello y");
+    EXPECT_EQ(call("scaled", "[2, 3]")["result"].asInt(), 6);
+}
+
+TEST_F(NamedParamsTest, MissingAndUnknownNames) {
+    // 缺失的 optional 参数为空，缺失的必需参数按 null 解码报错并带上参数名
+    EXPECT_EQ(call("greet", R"({"name": "z"})")["result"], "hello z");
+    EXPECT_EQ(call("divide", R"({"dividend": 1})")["error"]["message"],
+              "Invalid parameters: divisor: expected integer");
+    EXPECT_EQ(call("divide", R"({"dividend": 1, "divisor": "2"})")["error"]["message"],
+              "Invalid parameters: divisor: expected integer");
+    Json::Value unknown = call("divide", R"({"dividend": 1, "divisor": 1, "extra": 0})")["error"];
+    EXPECT_EQ(unknown["code"].asInt(), -32602);
+    EXPECT_EQ(unknown["message"], "Invalid parameters: Unknown parameter: extra");
+    EXPECT_EQ(call("scaled", R"({"value": 1, "scale": 2})")["error"]["code"].asInt(), -32602);
+    // 方法自己抛出的 invalid_argument 同样是 -32602，不带参数名
+    EXPECT_EQ(call("divide", R"({"dividend": 1, "divisor": 0})")["error"]["message"],
+              "Invalid parameters: division by zero");
+}
+
+TEST(ParamNamesTest, RegistrationChecksNames) {
+    EXPECT_THROW(ParamNames({"a", "b", "a"}), std::invalid_argument);
+    JsonRpcServer server;
+    EXPECT_THROW(server.registerMethod("add", [](int a, int b) { return a + b; }, ParamNames{"a"}),
+                 std::invalid_argument);
+    EXPECT_THROW(server.registerMethod<&divide>("divide", ParamNames{"a", "b", "c"}), std::invalid_argument);
+
+    ParamNames names{"alpha", "beta", "gamma"};
+    ASSERT_NE(names.find("gamma"), nullptr);
+    EXPECT_EQ(*names.find("gamma"), 2u);
+    EXPECT_EQ(names.find("delta"), nullptr);
+    EXPECT_EQ(names[1], "beta");
+}
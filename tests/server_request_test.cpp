@@ -0,0 +1,177 @@
+//
+// 服务器请求路径：单个请求的解析错误、无效请求、方法不存在与权限检查，批量请求按原顺序逐条响应，
+// 并行处理的批量请求与串行处理结果相同，响应默认紧凑输出且可切换为缩进格式；
+// 请求直接从帧缓冲区按长度解析，每个线程缓存的解析器在出错后可继续使用
+//
+
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "JsonRpcServer.h"
+#include "test_util.h"
+
+namespace {
+
+class ServerRequestTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        server.registerMethod("add", [](int a, int b) { return a + b; });
+        server.registerMethod("secret", [] { return "s"; }, false, "admin");
+    }
+
+    static std::string call(const std::string &method, const std::string &params, int id,
+                            const std::string &extra = "") {
+        return R"({"jsonrpc": "2.0", "method": ")" + method + R"(", "params": )" + params + R"(, "id": )" +
+               std::to_string(id) + extra + "}";
+    }
+
+    JsonRpcServer server;
+};
+
+} // namespace
+
+TEST_F(ServerRequestTest, SingleRequest) {
+    Json::Value response = processJson(server, call("add", "[2, 3]", 9));
+    EXPECT_EQ(response["jsonrpc"], "2.0");
+    EXPECT_EQ(response["result"].asInt(), 5);
+    EXPECT_EQ(response["id"].asInt(), 9);
+    EXPECT_FALSE(response.isMember("error"));
+}
+
+TEST_F(ServerRequestTest, SingleRequestErrors) {
+    Json::Value parseError = processJson(server, R"({"jsonrpc": "2.0", "method": )");
+    EXPECT_EQ(parseError["error"]["code"].asInt(), -32700);
+    EXPECT_EQ(parseError["id"].asInt(), 0);
+    Json::Value invalid = processJson(server, R"({"jsonrpc": "2.0", "method": 1, "id": 4})");
+    EXPECT_EQ(invalid["error"]["code"].asInt(), -32600);
+    EXPECT_EQ(invalid["id"].asInt(), 4);
+    EXPECT_EQ(processJson(server, R"({"jsonrpc": "2.0", "id": 4})")["error"]["code"].asInt(), -32600);
+    Json::Value missing = processJson(server, call("missing", "[]", 5));
+    EXPECT_EQ(missing["error"]["code"].asInt(), -32601);
+    EXPECT_EQ(missing["id"].asInt(), 5);
+    EXPECT_EQ(processJson(server, call("secret", "[]", 6))["error"]["code"].asInt(), -32001);
+    EXPECT_EQ(processJson(server, call("secret", "[]", 6, R"(, "userPermission": "guest")"))["error"]["code"]
+                      .asInt(), -32001);
+    EXPECT_EQ(processJson(server, call("secret", "[]", 6, R"(, "userPermission": "admin")"))["result"], "s");
+
+    Json::Value metrics = server.metrics();
+    EXPECT_EQ(metrics["errors"]["-32700"].asUInt64(), 1u);
+    EXPECT_EQ(metrics["errors"]["-32600"].asUInt64(), 2u);
+    EXPECT_EQ(metrics["errors"]["-32601"].asUInt64(), 1u);
+    EXPECT_EQ(metrics["methods"]["secret"]["errors"]["-32001"].asUInt64(), 2u);
+}
+
+TEST_F(ServerRequestTest, BatchAnswersEachEntryInOrder) {
+    Json::Value batch = processJson(server, "[" + call("add", "[1, 1]", 1) + "," + call("missing", "[]", 2) + "," +
+                                            call("add", R"(["x", 1])", 3) + "," + call("secret", "[]", 4) + "," +
+                                            call("add", "[2, 2]", 5) + "]");
+    ASSERT_TRUE(batch.isArray());
+    ASSERT_EQ(batch.size(), 5u);
+    for (Json::ArrayIndex i = 0; i < batch.size(); ++i) {
+        EXPECT_EQ(batch[i]["id"].asInt(), static_cast<int>(i) + 1);
+    }
+    EXPECT_EQ(batch[0]["result"].asInt(), 2);
+    EXPECT_EQ(batch[1]["error"]["code"].asInt(), -32601);
+    EXPECT_EQ(batch[2]["error"]["code"].asInt(), -32602);
+    EXPECT_EQ(batch[3]["error"]["code"].asInt(), -32001);
+    EXPECT_EQ(batch[4]["result"].asInt(), 4);
+    // 批量响应与逐条处理的响应相同
+    EXPECT_EQ(batch[2], processJson(server, call("add", R"(["x", 1])", 3)));
+}
+
+TEST_F(ServerRequestTest, ParallelBatchMatchesSerial) {
+    std::string request = "[";
+    for (int i = 0; i < 64; ++i) {
+        if (i > 0) request += ",";
+        request += i % 5 == 0 ? call("missing", "[]", i) : call("add", "[" + std::to_string(i) + ", 1]", i);
+    }
+    request += "]";
+    std::string serial = server.process(request);
+
+    server.setBatchParallelism(4);
+    EXPECT_EQ(server.process(request), serial);
+    Json::Value batch = processJson(server, request);
+    ASSERT_EQ(batch.size(), 64u);
+    EXPECT_EQ(batch[63]["result"].asInt(), 64);
+    EXPECT_EQ(batch[60]["error"]["code"].asInt(), -32601);
+}
+
+TEST_F(ServerRequestTest, SmallBatchRunsOnCallingThread) {
+    std::thread::id caller = std::this_thread::get_id();
+    server.registerMethod("sameThread", [caller] { return std::this_thread::get_id() == caller; });
+    server.setBatchParallelism(3);
+    std::string entry = call("sameThread", "[]", 1);
+    Json::Value batch = processJson(server, "[" + entry + "," + entry + "]");
+    ASSERT_EQ(batch.size(), 2u);
+    EXPECT_TRUE(batch[0]["result"].asBool());
+    EXPECT_TRUE(batch[1]["result"].asBool());
+}
+
+TEST_F(ServerRequestTest, CompactAndStyledOutput) {
+    server.registerMethod("echo", [](const Json::Value &value) { return value; });
+    std::string request = call("echo", R"([{"text": "a b\n", "list": [0.5, -2, true, null]}])", 3);
+    std::string compact = server.process(request);
+    EXPECT_EQ(compact.find('\n'), std::string::npos);
+    EXPECT_EQ(compact.find(": "), std::string::npos);
+    EXPECT_NE(compact.find(R"("text":"a b\n")"), std::string::npos);
+    EXPECT_NE(compact.find("[0.5,-2,true,null]"), std::string::npos);
+
+    server.setOutputStyle(JsonRpcProtocol::OutputStyle::Styled);
+    std::string styled = server.process(request);
+    EXPECT_NE(styled.find('\n'), std::string::npos);
+    Json::Value fromCompact;
+    Json::Value fromStyled;
+    ASSERT_TRUE(JsonRpcProtocol::parse(compact, fromCompact));
+    ASSERT_TRUE(JsonRpcProtocol::parse(styled, fromStyled));
+    EXPECT_EQ(fromStyled, fromCompact);
+}
+
+TEST_F(ServerRequestTest, ParsesFrameByLength) {
+    // 帧之后的字节不属于请求
+    std::string request = call("add", "[4, 5]", 2);
+    std::string frame = request + "garbage";
+    std::string reply = server.process(frame.data(), request.size());
+    Json::Value response;
+    ASSERT_TRUE(JsonRpcProtocol::parse(reply, response));
+    EXPECT_EQ(response["result"].asInt(), 9);
+    // 截断的帧是解析错误
+    reply = server.process(request.data(), request.size() - 1);
+    ASSERT_TRUE(JsonRpcProtocol::parse(reply, response));
+    EXPECT_EQ(response["error"]["code"].asInt(), -32700);
+}
+
+TEST_F(ServerRequestTest, CachedParserRecoversAfterErrors) {
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(processJson(server, R"({"method": [})")["error"]["code"].asInt(), -32700);
+        EXPECT_EQ(processJson(server, call("add", "[1, " + std::to_string(i) + "]", i))["result"].asInt(), i + 1);
+    }
+}
+
+TEST_F(ServerRequestTest, ConcurrentRequests) {
+    constexpr int kThreads = 4;
+    constexpr int kRequests = 200;
+    std::vector<int> failures(kThreads, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([this, t, &failures] {
+            for (int i = 0; i < kRequests; ++i) {
+                // 每 10 条夹一条无法解析的请求
+                bool malformed = i % 10 == 0;
+                std::string request = malformed ? "{" : call("add", "[" + std::to_string(t) + ", " +
+                                                                    std::to_string(i) + "]", i);
+                Json::Value response;
+                bool ok = JsonRpcProtocol::parse(server.process(request), response) &&
+                          (malformed ? response["error"]["code"].asInt() == -32700
+                                     : response["result"].asInt() == t + i);
+                if (!ok) ++failures[t];
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    for (int t = 0; t < kThreads; ++t) {
+        EXPECT_EQ(failures[t], 0) << t;
+    }
+}
@@ -0,0 +1,188 @@
+//
+// simdjson 后端（JSONRPC_USE_SIMDJSON）：解析结果与 jsoncpp 相同，单个同步请求从解析器视图解码参数，
+// 响应与通用路径逐字节相同，异步、批量、协程等请求仍走通用路径
+//
+
+#ifdef JSONRPC_USE_SIMDJSON
+
+#include <gtest/gtest.h>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "JsonRpcServer.h"
+#include "test_util.h"
+
+struct ViewPoint {
+    int x = 0;
+    int y = 0;
+    std::optional<std::string> label;
+};
+JSONRPC_REFLECT(ViewPoint, x, y, label)
+
+namespace {
+
+Json::Value parseWith(bool simdjson, const std::string &text) {
+    Json::Value value;
+    bool parsed = simdjson ? SimdjsonCodec::parse(text.data(), text.data() + text.size(), value, nullptr)
+                           : JsoncppCodec::parse(text.data(), text.data() + text.size(), value, nullptr);
+    EXPECT_TRUE(parsed) << text;
+    return value;
+}
+
+Task<int> coroutineTwice(int value) {
+    co_return value * 2;
+}
+
+class SimdjsonViewTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        server.registerMethod("add", [](int a, int b) { return a + b; });
+        server.registerMethod("sum", [](const std::vector<double> &values) {
+            double total = 0;
+            for (double value: values) total += value;
+            return total;
+        });
+        server.registerMethod("shift", [](const ViewPoint &point, int dx) {
+            ViewPoint moved = point;
+            moved.x += dx;
+            return moved;
+        });
+        server.registerMethod("length", [](std::string_view text, std::optional<int> extra) {
+            return static_cast<int>(text.size()) + extra.value_or(0);
+        });
+        server.registerMethod("narrow", [](int8_t small, uint32_t count) { return small + static_cast<int64_t>(count); });
+        server.registerMethod("echo", [](const Json::Value &value) { return value; });
+        server.registerMethod("none", [] { return "none"; });
+        server.registerMethod("sub", [](int a, int b) { return a - b; }, ParamNames{"a", "b"});
+        server.registerMethod("twice", coroutineTwice);
+        server.registerMethod("secret", [] { return 1; }, false, "admin");
+    }
+
+    // 同一请求加上 "ack": [] 即走通用路径，两条路径的响应应逐字节相同
+    void expectSameAsGeneric(const std::string &request) {
+        ASSERT_EQ(request.back(), '}');
+        std::string generic = request.substr(0, request.size() - 1) + R"(, "ack": []})";
+        EXPECT_EQ(server.process(request), server.process(generic)) << request;
+    }
+
+    static std::string call(const std::string &method, const std::string &params, const std::string &extra = "") {
+        return R"({"jsonrpc": "2.0", "method": ")" + method + R"(", "params": )" + params + R"(, "id": 7)" + extra +
+               "}";
+    }
+
+    JsonRpcServer server;
+};
+
+} // namespace
+
+TEST(SimdjsonCodecTest, MatchesJsoncpp) {
+    const std::vector<std::string> documents = {
+            R"({"a": [1, -2, 3.5, 1e3, true, false, null], "b": {"c": "x\"yé\n"}, "a": 0})",
+            R"([9223372036854775807, 9223372036854775808, -9223372036854775808, 18446744073709551615])",
+            R"([123456789012345678901234567890, -0.0, 1E-7, ""])",
+            R"("just a string")",
+            R"(42)",
+            R"({})",
+    };
+    for (const auto &document: documents) {
+        Json::Value expected = parseWith(false, document);
+        Json::Value actual = parseWith(true, document);
+        EXPECT_EQ(actual, expected) << document;
+        EXPECT_EQ(JsonCodec::serialize(actual, JsonOutputStyle::Compact),
+                  JsonCodec::serialize(expected, JsonOutputStyle::Compact)) << document;
+    }
+}
+
+TEST(SimdjsonCodecTest, RejectsMalformedInput) {
+    for (std::string text: {R"({"a": })", R"([1, 2)", R"({"a": 1} x)", R"(tru)", ""}) {
+        Json::Value value;
+        std::string errs;
+        EXPECT_FALSE(SimdjsonCodec::parse(text.data(), text.data() + text.size(), value, &errs)) << text;
+        EXPECT_FALSE(errs.empty());
+    }
+}
+
+TEST_F(SimdjsonViewTest, DecodesParamsFromView) {
+    EXPECT_EQ(processJson(server, call("add", "[5, 7]"))["result"].asInt(), 12);
+    EXPECT_DOUBLE_EQ(processJson(server, call("sum", "[[1, 2.5, 3]]"))["result"].asDouble(), 6.5);
+    Json::Value shifted = processJson(server, call("shift", R"([{"y": 2, "x": 1, "z": 0}, 10])"))["result"];
+    EXPECT_EQ(shifted["x"].asInt(), 11);
+    EXPECT_EQ(shifted["y"].asInt(), 2);
+    EXPECT_TRUE(shifted["label"].isNull());
+    EXPECT_EQ(processJson(server, call("length", R"(["héllo", null])"))["result"].asInt(), 6);
+    EXPECT_EQ(processJson(server, call("echo", R"([{"k": [1, "v"]}])"))["result"]["k"][1], "v");
+    EXPECT_EQ(processJson(server, call("sub", R"({"b": 2, "a": 9})"))["result"].asInt(), 7);
+    EXPECT_EQ(processJson(server, call("sub", "[9, 2]"))["result"].asInt(), 7);
+    EXPECT_EQ(processJson(server, R"({"jsonrpc": "2.0", "method": "none", "id": 3})")["result"], "none");
+}
+
+TEST_F(SimdjsonViewTest, ResponsesMatchGenericPath) {
+    const std::vector<std::string> requests = {
+            call("add", "[5, 7]"),
+            call("add", "[5.0, 7]"),
+            call("add", "[5.5, 7]"),
+            call("add", R"(["5", 7])"),
+            call("add", "[5]"),
+            call("add", "[1, 2, 3]"),
+            call("add", "{}"),
+            call("add", "null"),
+            call("add", "[2147483648, 1]"),
+            call("narrow", "[127, 4294967295]"),
+            call("narrow", "[128, 1]"),
+            call("narrow", "[1, -1]"),
+            call("narrow", "[1, 18446744073709551615]"),
+            call("narrow", "[1, 1e300]"),
+            call("sum", R"([[1, "x"]])"),
+            call("sum", "[[]]"),
+            call("sum", "[1]"),
+            call("shift", R"([{"x": "1"}, 1])"),
+            call("shift", R"([{"y": 1}, 1])"),
+            call("shift", R"([[1, 2], 1])"),
+            call("length", R"(["abc", 2])"),
+            call("length", R"([3, 2])"),
+            call("sub", R"({"a": 1})"),
+            call("sub", R"({"a": 1, "c": 2})"),
+            call("sub", R"({"a": 1, "b": "x"})"),
+            call("none", "[]"),
+            call("none", "[1]"),
+            call("secret", "[]"),
+            call("secret", "[]", R"(, "userPermission": "admin")"),
+            call("add", "[1, 2]", R"(, "timeout": 60000, "async": false, "client": "c1")"),
+            call("missing", "[]"),
+            R"({"jsonrpc": "2.0", "method": "add", "params": [1, 2]})",
+            R"({"jsonrpc": "2.0", "method": "add", "params": [1, 2], "id": null})",
+    };
+    for (const auto &request: requests) {
+        expectSameAsGeneric(request);
+    }
+}
+
+TEST_F(SimdjsonViewTest, OtherRequestsUseGenericPath) {
+    // 非 int 的 id、协程方法、内置方法、批量与异步请求都由通用路径处理
+    EXPECT_EQ(processJson(server, R"({"jsonrpc": "2.0", "method": "add", "params": [1, 2], "id": "a"})")["id"], 0);
+    EXPECT_EQ(processJson(server, call("twice", "[21]"))["result"].asInt(), 42);
+    EXPECT_EQ(processJson(server, call("getMetrics", R"(["add"])"))["result"]["methods"]["add"]["calls"].asUInt64(),
+              0u);
+    Json::Value batch = processJson(server, "[" + call("add", "[1, 1]") + "," + call("add", "[2, 2]") + "]");
+    ASSERT_EQ(batch.size(), 2u);
+    EXPECT_EQ(batch[1]["result"].asInt(), 4);
+    Json::Value accepted = processJson(server, call("add", "[3, 3]", R"(, "async": true, "client": "c1")"));
+    EXPECT_EQ(accepted["result"], "Task accepted");
+    EXPECT_EQ(pollAsyncResult(server, "c1", 7)["result"].asInt(), 6);
+    EXPECT_EQ(processJson(server, R"({"jsonrpc": "2.0", "method": "add", "params": [1, 2], "id": 1} [])")["error"]
+                      ["code"].asInt(), -32700);
+    EXPECT_EQ(processJson(server, R"({"jsonrpc": "2.0", "method": 5, "id": 1})")["error"]["code"].asInt(), -32600);
+}
+
+TEST_F(SimdjsonViewTest, CountsMetricsLikeGenericPath) {
+    processJson(server, call("add", "[1, 2]"));
+    processJson(server, call("add", R"(["x", 2])"));
+    processJson(server, call("secret", "[]"));
+    Json::Value metrics = server.metrics();
+    EXPECT_EQ(metrics["methods"]["add"]["calls"].asUInt64(), 2u);
+    EXPECT_EQ(metrics["methods"]["add"]["errors"]["-32602"].asUInt64(), 1u);
+    EXPECT_EQ(metrics["methods"]["secret"]["errors"]["-32001"].asUInt64(), 1u);
+}
+
+#endif // JSONRPC_USE_SIMDJSON
@@ -0,0 +1,36 @@
+//
+// 测试共用的辅助函数
+//
+
+#ifndef JSON_RPC_TEST_UTIL_H
+#define JSON_RPC_TEST_UTIL_H
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include "JsonRpcServer.h"
+
+// 把请求交给 server.process() 并解析响应
+inline Json::Value processJson(JsonRpcServer &server, const std::string &request) {
+    Json::Value response;
+    EXPECT_TRUE(JsonRpcProtocol::parse(server.process(request), response)) << request;
+    return response;
+}
+
+// 轮询 getAsyncResult 直到结果不再是 "Task still processing" 或超时
+inline Json::Value pollAsyncResult(JsonRpcServer &server, const std::string &client, int id,
+                                   std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+    std::string request = R"({"jsonrpc": "2.0", "method": "getAsyncResult", "params": [)" + std::to_string(id) +
+                          R"(], "id": )" + std::to_string(id) + R"(, "client": ")" + client + R"("})";
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (true) {
+        Json::Value response = processJson(server, request);
+        if (response["result"] != "Task still processing" || std::chrono::steady_clock::now() > deadline) {
+            return response;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+#endif // JSON_RPC_TEST_UTIL_H
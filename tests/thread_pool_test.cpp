@@ -0,0 +1,118 @@
+//
+// ThreadPool：任务执行、排队上限、工作窃取与析构时排空
+//
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <optional>
+#include <thread>
+#include <vector>
+#include "ThreadPool.h"
+
+TEST(ThreadPoolTest, ExecutesAllTasks) {
+    ThreadPool pool(4, 4096);
+    std::vector<std::future<int>> futures;
+    for (int i = 0; i < 2000; ++i) {
+        auto future = pool.trySubmit([i] { return i * 2; });
+        ASSERT_TRUE(future.has_value());
+        futures.push_back(std::move(*future));
+    }
+    long sum = 0;
+    for (auto &future: futures) sum += future.get();
+    EXPECT_EQ(sum, 2000L * 1999);
+    // executed 在 future 就绪之后才递增
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (pool.stats().executed < 2000 && std::chrono::steady_clock::now() < deadline) std::this_thread::yield();
+    EXPECT_EQ(pool.stats().executed, 2000u);
+    EXPECT_EQ(pool.stats().rejected, 0u);
+}
+
+TEST(ThreadPoolTest, RejectsWhenQueueIsFull) {
+    ThreadPool pool(1, 2);
+    std::promise<void> started;
+    std::promise<void> release;
+    auto blocker = pool.trySubmit([&started, gate = release.get_future().share()] {
+        started.set_value();
+        gate.wait();
+    });
+    ASSERT_TRUE(blocker.has_value());
+    // 唯一的工作线程被占住后，排队名额只剩 maxQueued 个
+    started.get_future().wait();
+    auto first = pool.trySubmit([] { return 1; });
+    auto second = pool.trySubmit([] { return 2; });
+    auto third = pool.trySubmit([] { return 3; });
+    EXPECT_TRUE(first.has_value());
+    EXPECT_TRUE(second.has_value());
+    EXPECT_FALSE(third.has_value());
+    EXPECT_EQ(pool.stats().queued, 2u);
+    EXPECT_EQ(pool.stats().rejected, 1u);
+
+    release.set_value();
+    EXPECT_EQ(first->get(), 1);
+    EXPECT_EQ(second->get(), 2);
+    auto fourth = pool.trySubmit([] { return 4; });
+    ASSERT_TRUE(fourth.has_value());
+    EXPECT_EQ(fourth->get(), 4);
+}
+
+TEST(ThreadPoolTest, IdleWorkerStealsFromBusyOne) {
+    constexpr int kChildren = 64;
+    ThreadPool pool(2, 1024);
+    // 工作线程内提交的任务进入本线程队列；父任务阻塞等待，子任务只能被另一个线程窃取执行
+    auto parent = pool.trySubmit([&pool] {
+        std::vector<std::future<int>> children;
+        for (int i = 0; i < kChildren; ++i) {
+            auto child = pool.trySubmit([i] { return i; });
+            if (!child) return -1;
+            children.push_back(std::move(*child));
+        }
+        int sum = 0;
+        for (auto &child: children) sum += child.get();
+        return sum;
+    });
+    ASSERT_TRUE(parent.has_value());
+    ASSERT_EQ(parent->wait_for(std::chrono::seconds(10)), std::future_status::ready);
+    EXPECT_EQ(parent->get(), kChildren * (kChildren - 1) / 2);
+    EXPECT_GE(pool.stats().steals, static_cast<uint64_t>(kChildren));
+}
+
+TEST(ThreadPoolTest, DestructorDrainsQueuedTasks) {
+    std::atomic<int> done{0};
+    {
+        ThreadPool pool(2, 256);
+        for (int i = 0; i < 200; ++i) {
+            ASSERT_TRUE(pool.trySubmit([&done] {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+                done.fetch_add(1);
+            }).has_value());
+        }
+    }
+    EXPECT_EQ(done.load(), 200);
+}
+
+TEST(ThreadPoolTest, ConcurrentSubmittersRespectBound) {
+    constexpr int kSubmitters = 8;
+    constexpr int kPerSubmitter = 5000;
+    constexpr size_t kMaxQueued = 64;
+    std::atomic<int> done{0};
+    std::atomic<uint64_t> accepted{0};
+    {
+        ThreadPool pool(4, kMaxQueued);
+        std::atomic<bool> overflow{false};
+        std::vector<std::thread> submitters;
+        for (int t = 0; t < kSubmitters; ++t) {
+            submitters.emplace_back([&] {
+                for (int i = 0; i < kPerSubmitter; ++i) {
+                    if (pool.trySubmit([&done] { done.fetch_add(1); })) accepted.fetch_add(1);
+                    if (pool.stats().queued > kMaxQueued) overflow = true;
+                }
+            });
+        }
+        for (auto &thread: submitters) thread.join();
+        EXPECT_FALSE(overflow.load());
+        EXPECT_EQ(accepted.load() + pool.stats().rejected, static_cast<uint64_t>(kSubmitters * kPerSubmitter));
+    }
+    EXPECT_EQ(static_cast<uint64_t>(done.load()), accepted.load());
+}